@@ -5,14 +5,80 @@
 #include <climits>
 #include <cmath>
 #include <cstdlib>
+#include <cstdint>
 #include <vector>
 #include <string>
 #include <iostream>
 #include <map>
 #include <set>
+#include <list>
+#include <unordered_map>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+
+// x86 SIMD kernels are compiled per function with target attributes and
+// chosen at runtime, so the engine still builds and runs without -mavx2
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define ARCADIA_X86_SIMD 1
+#include <immintrin.h>
+#endif
 
 using namespace std;
 
+static bool cpuHasAVX2() {
+#ifdef ARCADIA_X86_SIMD
+    static const bool hasAVX2 = __builtin_cpu_supports("avx2");
+    return hasAVX2;
+#else
+    return false;
+#endif
+}
+
+static bool cpuHasAVX512() {
+#ifdef ARCADIA_X86_SIMD
+    static const bool hasAVX512 = __builtin_cpu_supports("avx512f");
+    return hasAVX512;
+#else
+    return false;
+#endif
+}
+
+// Number of worker threads to use; threads <= 0 means one per hardware core
+static int resolveThreadCount(int threads) {
+    if (threads > 0) return threads;
+    int cores = thread::hardware_concurrency();
+    return cores > 0 ? cores : 1;
+}
+
+// Reusable barrier for a fixed group of threads (std::barrier is C++20)
+class ThreadBarrier {
+private:
+    mutex lock;
+    condition_variable released;
+    int parties;
+    int waiting;
+    long long generation;
+
+public:
+    explicit ThreadBarrier(int parties) : parties(parties), waiting(0), generation(0) {}
+
+    void arriveAndWait() {
+        unique_lock<mutex> guard(lock);
+        long long arrivedIn = generation;
+        if (++waiting == parties) {
+            waiting = 0;
+            generation++;
+            released.notify_all();
+            return;
+        }
+        released.wait(guard, [&] { return generation != arrivedIn; });
+    }
+};
+
 // =========================================================
 // PART A: DATA STRUCTURES (Concrete Implementations)
 // =========================================================
@@ -309,289 +375,388 @@ public:
 class ConcreteAuctionTree : public AuctionTree {
 private:
     // Define your Red-Black Tree node structure
-    // Each node needs: id, price, color, left, right, parent pointers
-    enum Color{
-        black,
-        red
-    };
+    // Nodes live in one pool and link to each other by 32-bit index instead
+    // of pointer; the color is packed into the top bit of the parent index.
+    // This keeps a listing at 20 bytes instead of ~48.
+    static constexpr uint32_t RED_BIT = 0x80000000u;
+    static constexpr uint32_t NIL = 0;  // pool slot 0 is the sentinel, always black
 
     struct RedBlackNode{
         int ID;
-        double price;
-        Color color;         // color of node
-        RedBlackNode* left;  // left child 
-        RedBlackNode* right; // right child
-        RedBlackNode* p;     // parent node
-
-        RedBlackNode(int itemID, int price){
-            this->ID = itemID;
-            this->price = price;
-        };
+        int price;
+        uint32_t left;       // left child index
+        uint32_t right;      // right child index
+        uint32_t parentBits; // parent index | RED_BIT when node is red
+    };
+    static_assert(sizeof(RedBlackNode) == 20, "RedBlackNode must stay 20 bytes");
+
+    // Entry of the expiry min-heap, ordered by (expiresAt, price, ID)
+    // Entries are removed lazily: deleteItem leaves them in the heap and
+    // expireUpTo skips the ones whose listing is gone or was re-listed
+    struct ExpiryEntry{
+        long long expiresAt;
+        int price;
+        int ID;
+
+        bool operator>(const ExpiryEntry& other) const {
+            if (expiresAt != other.expiresAt) return expiresAt > other.expiresAt;
+            if (price != other.price) return price > other.price;
+            return ID > other.ID;
+        }
     };
 
-    RedBlackNode* NIL;  // null pointer always black
-    RedBlackNode* root; // root of the tree always black
+    vector<RedBlackNode> pool; // node storage, slot 0 is NIL
+    vector<long long> expiry;  // expiry per pool slot, only allocated once an expiring item is listed
+    uint32_t freeList;         // head of recycled slots, chained through left
+    uint32_t root;             // root of the tree always black
+    priority_queue<ExpiryEntry, vector<ExpiryEntry>, greater<ExpiryEntry>> expiryQueue;
+
+    // ------ Node accessors -----------
+    uint32_t& left(uint32_t x) { return pool[x].left; }
+    uint32_t& right(uint32_t x) { return pool[x].right; }
+    uint32_t parent(uint32_t x) { return pool[x].parentBits & ~RED_BIT; }
+    void setParent(uint32_t x, uint32_t p) { pool[x].parentBits = (pool[x].parentBits & RED_BIT) | p; }
+    bool isRed(uint32_t x) { return (pool[x].parentBits & RED_BIT) != 0; }
+    void setRed(uint32_t x) { pool[x].parentBits |= RED_BIT; }
+    void setBlack(uint32_t x) { pool[x].parentBits &= ~RED_BIT; }
+    void copyColor(uint32_t to, uint32_t from) { if (isRed(from)) setRed(to); else setBlack(to); }
+    long long expiresAt(uint32_t x) { return expiry.empty() ? LLONG_MAX : expiry[x]; }
+    // -----------------------------------
+
 public:
     ConcreteAuctionTree() {
         // Initialize your Red-Black Tree
-        NIL = new RedBlackNode(NULL, NULL);
-        NIL->color = black;
-        NIL->left = NIL->right = NIL->p = NIL;
+        pool.push_back({0, 0, NIL, NIL, NIL}); // NIL sentinel, black
+        freeList = NIL;
         root = NIL;
     }
 
     void insertItem(int itemID, int price) override {
+        insertItem(itemID, price, LLONG_MAX);
+    }
+
+    void insertItem(int itemID, int price, long long expiresAt) override {
         // Implement Red-Black Tree insertion
 
         // initialize node with given parameters
-        RedBlackNode* x = new RedBlackNode(itemID, price);
-        x->left = x->right = NIL;
-        x->p = NIL;
-        
+        uint32_t x = allocateNode(itemID, price);
+        if (expiresAt != LLONG_MAX) {
+            if (expiry.empty()) {
+                expiry.assign(pool.size(), LLONG_MAX);
+            }
+            expiryQueue.push({expiresAt, price, itemID});
+        }
+        if (!expiry.empty()) {
+            expiry[x] = expiresAt;
+        }
+
         // Insert node using BST insertion
-        root = bstInsert(root, x);
-        
+        bstInsert(x);
+
         // fix RB properties
-        x->color = red;
-        while(x != root && x->p->color == red){
+        setRed(x);
+        while(x != root && isRed(parent(x))){
+            uint32_t xp = parent(x);
+            uint32_t xpp = parent(xp);
             // if the node's parent is left therefore the x is in the left subtree
-            if (x->p == x->p->p->left){
-                RedBlackNode* y = x->p->p->right; // Uncle node
-                if(y->color == red){  // Case 1 uncle is red
-                    y->color = black;
-                    x->p->color = black;
-                    x->p->p->color = red;
-                    x = x->p->p;
+            if (xp == left(xpp)){
+                uint32_t y = right(xpp); // Uncle node
+                if(isRed(y)){  // Case 1 uncle is red
+                    setBlack(y);
+                    setBlack(xp);
+                    setRed(xpp);
+                    x = xpp;
                 } else { // Case 2 and Case 3 uncle is black (rotate)
                     // x is right child of parent (left rotate then right rotate)
-                    if(x == x->p->right){
-                        x = x->p;
+                    if(x == right(xp)){
+                        x = xp;
                         leftRotate(x);
                     }
-                    x->p->color = black;
-                    x->p->p->color = red;
-                    rightRotate(x->p->p);
+                    setBlack(parent(x));
+                    setRed(parent(parent(x)));
+                    rightRotate(parent(parent(x)));
                 }
             } else {
                 // if the node's parent is right therefore the x is in the right subtree
-                RedBlackNode* y = x->p->p->left; // Uncle node
-                if(y->color == red){  // Case 1 uncle is red
-                    y->color = black;
-                    x->p->color = black;
-                    x->p->p->color = red;
-                    x = x->p->p;
+                uint32_t y = left(xpp); // Uncle node
+                if(isRed(y)){  // Case 1 uncle is red
+                    setBlack(y);
+                    setBlack(xp);
+                    setRed(xpp);
+                    x = xpp;
                 } else { // Case 2 and Case 3 uncle is black (rotate)
                     // x is right child of parent (right rotate then left rotate)
-                    if(x == x->p->left){
-                        x = x->p;
+                    if(x == left(xp)){
+                        x = xp;
                         rightRotate(x);
                     }
-                    x->p->color = black;
-                    x->p->p->color = red;
-                    leftRotate(x->p->p);
+                    setBlack(parent(x));
+                    setRed(parent(parent(x)));
+                    leftRotate(parent(parent(x)));
                 }
             }
         }
-        root->color = black;
+        setBlack(root);
     }
 
     void deleteItem(int itemID) override {
-        // Find the node to delete
-        RedBlackNode* z = search(root, itemID);
+        // Find the node to delete (tree is ordered by price, so scan by ID)
+        uint32_t z = search(root, itemID);
         if (z == NIL) return; // Node not found
-        
-        RedBlackNode* x;
-        RedBlackNode* y;
-        
+        deleteNode(z);
+    }
+
+    int expireUpTo(long long now) override {
+        // Pop every due entry from the expiry heap and remove its listing
+        // with an O(log n) keyed lookup instead of an O(n) ID scan
+        int expired = 0;
+        while (!expiryQueue.empty() && expiryQueue.top().expiresAt <= now) {
+            ExpiryEntry e = expiryQueue.top();
+            expiryQueue.pop();
+
+            uint32_t z = searchKey(e.price, e.ID);
+            // Stale entry: listing already deleted or re-listed with another expiry
+            if (z == NIL || expiresAt(z) != e.expiresAt) continue;
+
+            deleteNode(z);
+            expired++;
+        }
+        return expired;
+    }
+
+    size_t nodeBytes() const override {
+        return pool.size() * sizeof(RedBlackNode);
+    }
+
+    // --------- HELPER FUNCTIONS --------------
+    // take a slot from the free list or grow the pool
+    uint32_t allocateNode(int itemID, int price) {
+        uint32_t x;
+        if (freeList != NIL) {
+            x = freeList;
+            freeList = left(x);
+        } else {
+            x = pool.size();
+            pool.push_back({});
+            if (!expiry.empty()) {
+                expiry.push_back(LLONG_MAX);
+            }
+        }
+        pool[x] = {itemID, price, NIL, NIL, NIL};
+        return x;
+    }
+
+    // return a slot to the free list
+    void freeNode(uint32_t x) {
+        left(x) = freeList;
+        freeList = x;
+    }
+
+    // remove node z from the tree and restore RB properties
+    void deleteNode(uint32_t z) {
+        uint32_t x;
+        uint32_t y;
+
         // Find node y which is going to be removed
-        if (z->left == NIL || z->right == NIL) {
+        if (left(z) == NIL || right(z) == NIL) {
             y = z;
         } else {
             y = successor(z);
-            z->ID = y->ID;
-            z->price = y->price;
+            pool[z].ID = pool[y].ID;
+            pool[z].price = pool[y].price;
+            if (!expiry.empty()) {
+                expiry[z] = expiry[y];
+            }
         }
-        
+
         // Find child x of y
-        if (y->right != NIL) {
-            x = y->right;
+        if (right(y) != NIL) {
+            x = right(y);
         } else {
-            x = y->left;
+            x = left(y);
         }
-        
-        // Note x might be NIL; create a pretend node
-        if (x == NIL) {
-            x = new RedBlackNode(0, 0);
-            x->color = black;
-            x->left = x->right = NIL;
-        }
-        
-        // Detach x from y
-        x->p = y->p;
-        
-        if (y->p == NIL) {
+
+        // Detach x from y (x might be NIL; the sentinel's parent is
+        // borrowed temporarily so the fixup can walk up from it)
+        setParent(x, parent(y));
+
+        if (parent(y) == NIL) {
             root = x;
         } else {
-            if (y == y->p->left) {
-                y->p->left = x;
+            if (y == left(parent(y))) {
+                left(parent(y)) = x;
             } else {
-                y->p->right = x;
+                right(parent(y)) = x;
             }
         }
-        
+
         // Fix tree if removed node was black
-        if (y->color == black) {
-            while (x != root && x->color == black) {
-                if (x == x->p->left) {
-                    RedBlackNode* w = x->p->right;
-                    
-                    if (w->color == red) {
-                        w->color = black;
-                        x->p->color = red;
-                        leftRotate(x->p);
-                        w = x->p->right;
+        if (!isRed(y)) {
+            while (x != root && !isRed(x)) {
+                uint32_t xp = parent(x);
+                if (x == left(xp)) {
+                    uint32_t w = right(xp);
+
+                    if (isRed(w)) {
+                        setBlack(w);
+                        setRed(xp);
+                        leftRotate(xp);
+                        w = right(xp);
                     }
-                    
-                    if (w->left->color == black && w->right->color == black) {
-                        w->color = red;
-                        x = x->p;
+
+                    if (!isRed(left(w)) && !isRed(right(w))) {
+                        setRed(w);
+                        x = xp;
                     } else {
-                        if (w->right->color == black) {
-                            w->left->color = black;
-                            w->color = red;
+                        if (!isRed(right(w))) {
+                            setBlack(left(w));
+                            setRed(w);
                             rightRotate(w);
-                            w = x->p->right;
+                            w = right(xp);
                         }
-                        w->color = x->p->color;
-                        x->p->color = black;
-                        w->right->color = black;
-                        leftRotate(x->p);
+                        copyColor(w, xp);
+                        setBlack(xp);
+                        setBlack(right(w));
+                        leftRotate(xp);
                         x = root;
                     }
                 } else {
-                    RedBlackNode* w = x->p->left;
-                    
-                    if (w->color == red) {
-                        w->color = black;
-                        x->p->color = red;
-                        rightRotate(x->p);
-                        w = x->p->left;
+                    uint32_t w = left(xp);
+
+                    if (isRed(w)) {
+                        setBlack(w);
+                        setRed(xp);
+                        rightRotate(xp);
+                        w = left(xp);
                     }
-                    
-                    if (w->right->color == black && w->left->color == black) {
-                        w->color = red;
-                        x = x->p;
+
+                    if (!isRed(right(w)) && !isRed(left(w))) {
+                        setRed(w);
+                        x = xp;
                     } else {
-                        if (w->left->color == black) {
-                            w->right->color = black;
-                            w->color = red;
+                        if (!isRed(left(w))) {
+                            setBlack(right(w));
+                            setRed(w);
                             leftRotate(w);
-                            w = x->p->left;
+                            w = left(xp);
                         }
-                        w->color = x->p->color;
-                        x->p->color = black;
-                        w->left->color = black;
-                        rightRotate(x->p);
+                        copyColor(w, xp);
+                        setBlack(xp);
+                        setBlack(left(w));
+                        rightRotate(xp);
                         x = root;
                     }
                 }
             }
-            x->color = black;
-        }
-        
-        // x is a pretend node (check if ID is 0)
-        if (x->ID == 0) {
-            if (x == x->p->left) {
-                x->p->left = NIL;
-            } else {
-                x->p->right = NIL;
-            }
-            delete x;
+            setBlack(x);
         }
+
+        // restore the sentinel (parent and color may have been touched)
+        pool[NIL].parentBits = NIL;
+        freeNode(y);
     }
 
-    // --------- HELPER FUNCTIONS --------------
     // search for a node by ID
-    RedBlackNode* search(RedBlackNode* node, int itemID) {
-        if (node == NIL || node->ID == itemID) {
+    uint32_t search(uint32_t node, int itemID) {
+        if (node == NIL || pool[node].ID == itemID) {
             return node;
         }
-        if (itemID < node->ID) {
-            return search(node->left, itemID);
+        uint32_t found = search(left(node), itemID);
+        if (found != NIL) {
+            return found;
         }
-        return search(node->right, itemID);
+        return search(right(node), itemID);
     }
-    
+
+    // search for a node by its composite key (price, ID)
+    uint32_t searchKey(int price, int itemID) {
+        uint32_t node = root;
+        while (node != NIL && (pool[node].price != price || pool[node].ID != itemID)) {
+            if (price < pool[node].price || (price == pool[node].price && itemID < pool[node].ID)) {
+                node = left(node);
+            } else {
+                node = right(node);
+            }
+        }
+        return node;
+    }
+
     // left rotate
-    void leftRotate(RedBlackNode* x) {
-        RedBlackNode* y = x->right;
-        x->right = y->left;
-        
-        if (y->left != NIL) {
-            y->left->p = x;
+    void leftRotate(uint32_t x) {
+        uint32_t y = right(x);
+        right(x) = left(y);
+
+        if (left(y) != NIL) {
+            setParent(left(y), x);
         }
-        
-        y->p = x->p;
-        
-        if (x->p == NIL) {
+
+        setParent(y, parent(x));
+
+        if (parent(x) == NIL) {
             root = y;
-        } else if (x == x->p->left) {
-            x->p->left = y;
+        } else if (x == left(parent(x))) {
+            left(parent(x)) = y;
         } else {
-            x->p->right = y;
+            right(parent(x)) = y;
         }
-        
-        y->left = x;
-        x->p = y;
+
+        left(y) = x;
+        setParent(x, y);
     }
-    
+
     // right rotate
-    void rightRotate(RedBlackNode* y) {
-        RedBlackNode* x = y->left;
-        y->left = x->right;
-        
-        if (x->right != NIL) {
-            x->right->p = y;
+    void rightRotate(uint32_t y) {
+        uint32_t x = left(y);
+        left(y) = right(x);
+
+        if (right(x) != NIL) {
+            setParent(right(x), y);
         }
-        
-        x->p = y->p;
-        
-        if (y->p == NIL) {
+
+        setParent(x, parent(y));
+
+        if (parent(y) == NIL) {
             root = x;
-        } else if (y == y->p->left) {
-            y->p->left = x;
+        } else if (y == left(parent(y))) {
+            left(parent(y)) = x;
         } else {
-            y->p->right = x;
+            right(parent(y)) = x;
         }
-        
-        x->right = y;
-        y->p = x;
+
+        right(x) = y;
+        setParent(y, x);
     }
 
-    // BST Insert
-    RedBlackNode* bstInsert(RedBlackNode* node, RedBlackNode* newNode) {
-        // If tree is empty or reached leaf position
-        if (node == NIL) {
-            return newNode;
+    // BST Insert (iterative, ordered by (price, ID))
+    void bstInsert(uint32_t newNode) {
+        int price = pool[newNode].price;
+        int itemID = pool[newNode].ID;
+        uint32_t p = NIL;
+        uint32_t node = root;
+        bool goLeft = false;
+
+        // Walk down to the leaf position
+        while (node != NIL) {
+            p = node;
+            goLeft = price < pool[node].price || (price == pool[node].price && itemID < pool[node].ID);
+            node = goLeft ? left(node) : right(node);
         }
-        
-        // Recursively find position and insert
-        if (newNode->price < node->price || (newNode->price == node->price && newNode->ID < node->ID)) {
-            node->left = bstInsert(node->left, newNode);
-            node->left->p = node;
+
+        setParent(newNode, p);
+        if (p == NIL) {
+            root = newNode;
+        } else if (goLeft) {
+            left(p) = newNode;
         } else {
-            node->right = bstInsert(node->right, newNode);
-            node->right->p = node;
+            right(p) = newNode;
         }
-        
-        return node;
     }
-    
+
     // find successor
-    RedBlackNode* successor(RedBlackNode* z) {
-        RedBlackNode* y = z->right;
-        while (y->left != NIL) {
-            y = y->left;
+    uint32_t successor(uint32_t z) {
+        uint32_t y = right(z);
+        while (left(y) != NIL) {
+            y = left(y);
         }
         return y;
     }
@@ -601,42 +766,151 @@ public:
 // =========================================================
 // PART B: INVENTORY SYSTEM (Dynamic Programming)
 // =========================================================
-int InventorySystem::optimizeLootSplit(int n, vector<int>& coins) {
-    // TODO: Implement partition problem using DP
-    // Goal: Minimize |sum(subset1) - sum(subset2)|
-    // Hint: Use subset sum DP to find closest sum to total/2
-    int totalSum = 0;
-    for (int x : coins)
-        totalSum += x;
+// --- Subset-sum bitset kernels ---
+// Bit j of reach is set when sum j is reachable. Adding a coin is
+// reach |= reach << coin, done in place from the top word down so every
+// source word is read before it is overwritten.
+static void shiftOrScalar(vector<uint64_t>& reach, int coin, int from) {
+    int wordShift = coin / 64;
+    int bitShift = coin % 64;
+    uint64_t* r = reach.data();
+    for (int i = from; i >= wordShift; i--) {
+        uint64_t shifted = r[i - wordShift] << bitShift;
+        if (bitShift != 0 && i - wordShift - 1 >= 0) {
+            shifted |= r[i - wordShift - 1] >> (64 - bitShift);
+        }
+        r[i] |= shifted;
+    }
+}
 
-    int halfCoins = totalSum / 2;
+#ifdef ARCADIA_X86_SIMD
+__attribute__((target("avx2")))
+static void shiftOrAVX2(vector<uint64_t>& reach, int coin, int from) {
+    int wordShift = coin / 64;
+    int bitShift = coin % 64;
+    uint64_t* r = reach.data();
+    __m128i left = _mm_cvtsi32_si128(bitShift);
+    __m128i right = _mm_cvtsi32_si128(64 - bitShift); // 64 shifts every bit out
+    int i = from;
+    // 4 words per step; the lowest source word read is i - 3 - wordShift - 1
+    for (; i - 3 - wordShift - 1 >= 0; i -= 4) {
+        __m256i hi = _mm256_loadu_si256((const __m256i*)(r + i - 3 - wordShift));
+        __m256i lo = _mm256_loadu_si256((const __m256i*)(r + i - 3 - wordShift - 1));
+        __m256i shifted = _mm256_or_si256(_mm256_sll_epi64(hi, left), _mm256_srl_epi64(lo, right));
+        __m256i dst = _mm256_loadu_si256((const __m256i*)(r + i - 3));
+        _mm256_storeu_si256((__m256i*)(r + i - 3), _mm256_or_si256(dst, shifted));
+    }
+    shiftOrScalar(reach, coin, i);
+}
+#endif
+
+// Reachable subset sums 0..limit of coins[first..last) as a bitset
+static vector<uint64_t> buildReach(const vector<int>& coins, int first, int last, int limit) {
+    int words = limit / 64 + 1;
+    vector<uint64_t> reach(words, 0);
+    reach[0] = 1; // sum 0 is always reachable
+
+    for (int i = first; i < last; i++) {
+        int coin = coins[i];
+        if (coin <= 0 || coin > limit)
+            continue; // can never help a sum <= limit
+#ifdef ARCADIA_X86_SIMD
+        if (cpuHasAVX2()) {
+            shiftOrAVX2(reach, coin, words - 1);
+            continue;
+        }
+#endif
+        shiftOrScalar(reach, coin, words - 1);
+    }
+    return reach;
+}
 
-    vector<vector<int>> dp(n + 1, vector<int>(halfCoins + 1, 0));
+static bool testBit(const vector<uint64_t>& bits, long long i) {
+    return (bits[i / 64] >> (i % 64)) & 1;
+}
 
-    // Base cases
-    dp[0][0] = 1;
-    for (int i = 1; i <= n; i++)
-        dp[i][0] = 1;
+// Few-but-huge coins: the bitset would need total/2 bits, so split each
+// half's subsets instead. Limits keep both sides at <= 2^20 sums and the
+// bitset at <= 32MB
+static const int kLootMeetInTheMiddleMaxCoins = 40;
+static const long long kLootBitsetMaxSum = 1LL << 28;
+
+static vector<vector<int>> karmarkarKarpSplit(const vector<int>& coins, int k);
+static long long groupsSpread(const vector<vector<int>>& groups, const vector<int>& coins);
+
+static bool preferLootMeetInTheMiddle(int n, long long half) {
+    if (n > kLootMeetInTheMiddleMaxCoins) return false;
+    if (half > kLootBitsetMaxSum) return true;
+    double mitmWork = ldexp(1.0, (n + 1) / 2) * (n / 2 + 1);
+    double bitsetWork = (double)n * (half / 64 + 1);
+    return mitmWork < bitsetWork;
+}
 
+// All subset sums of coins[first..last), each with its subset as a bitmask
+static vector<pair<long long, uint64_t>> lootHalfSums(const vector<int>& coins, int first, int last) {
+    vector<pair<long long, uint64_t>> sums = {{0, 0}};
+    sums.reserve(1ULL << (last - first));
+    for (int i = first; i < last; i++) {
+        size_t count = sums.size();
+        for (size_t j = 0; j < count; j++) {
+            sums.push_back({sums[j].first + coins[i], sums[j].second | (1ULL << i)});
+        }
+    }
+    return sums;
+}
 
-    for (int i = 1; i <= n; i++) {
-        for (int j = 1; j <= halfCoins; j++) {
-            if (j < coins[i - 1]) {
-                dp[i][j] = dp[i - 1][j];
-            } else {
-                if (dp[i - 1][j] == 1 ||
-                    dp[i - 1][j - coins[i - 1]] == 1)
-                    dp[i][j] = 1;
-                else
-                    dp[i][j] = 0;
-            }
+// Meet in the middle: best subset sum <= half of coins[0..n), with the
+// chosen coins in mask. Both halves sorted, then one two-pointer merge.
+// O(2^(n/2) * n) time, 64-bit sums throughout
+static long long lootSplitMeetInTheMiddle(const vector<int>& coins, int n, long long half, uint64_t& mask) {
+    vector<pair<long long, uint64_t>> left = lootHalfSums(coins, 0, n / 2);
+    vector<pair<long long, uint64_t>> right = lootHalfSums(coins, n / 2, n);
+    sort(left.begin(), left.end());
+    sort(right.begin(), right.end());
+
+    long long best = 0;
+    mask = 0;
+    int j = right.size() - 1;
+    for (auto& l : left) {
+        // left sums grow, so the matching right sum can only shrink
+        while (j >= 0 && l.first + right[j].first > half) j--;
+        if (j < 0) break;
+        if (l.first + right[j].first > best) {
+            best = l.first + right[j].first;
+            mask = l.second | right[j].second;
         }
     }
+    return best;
+}
+
+int InventorySystem::optimizeLootSplit(int n, vector<int>& coins) {
+    // Partition problem: find the reachable subset sum closest to total/2
+    // Goal: Minimize |sum(subset1) - sum(subset2)|
+    // One rolling bitset of sums 0..total/2 (1 bit per sum instead of an
+    // (n+1) x (sum/2+1) int table), updated with word-parallel shift-or.
+    // Sums are 64-bit; the answer never exceeds the largest coin, so it fits an int
+    long long totalSum = 0;
+    for (int i = 0; i < n; i++)
+        totalSum += coins[i];
+
+    long long halfCoins = totalSum / 2;
+    if (preferLootMeetInTheMiddle(n, halfCoins)) {
+        uint64_t mask;
+        long long best = lootSplitMeetInTheMiddle(coins, n, halfCoins, mask);
+        return totalSum - 2 * best;
+    }
+    if (halfCoins > kLootBitsetMaxSum) {
+        // Too many huge coins for an exact answer: largest differencing
+        vector<int> used(coins.begin(), coins.begin() + n);
+        return groupsSpread(karmarkarKarpSplit(used, 2), used);
+    }
+
+    vector<uint64_t> reach = buildReach(coins, 0, n, halfCoins);
 
     // Find the best sum near to half of total
-    int best = 0;
-    for (int i = halfCoins; i >= 0; i--) {
-        if (dp[n][i] == 1) {             // to check if sum is possible using all coins
+    long long best = 0;
+    for (long long i = halfCoins; i >= 0; i--) {
+        if (testBit(reach, i)) {
             best = i;
             break;
         }
@@ -645,267 +919,2819 @@ int InventorySystem::optimizeLootSplit(int n, vector<int>& coins) {
     return totalSum - 2 * best;
 }
 
-int InventorySystem::maximizeCarryValue(int capacity, vector<pair<int, int>>& items) {
-    // TODO: Implement 0/1 Knapsack using DP
-    // items = {weight, value} pairs
-    // Return maximum value achievable within capacity
-
-    if (items.empty() || capacity == 0) {
-        return 0;
+// Hirschberg-style reconstruction: pick the coins of [first..last) that sum
+// to target. The sum is split between the two halves by intersecting their
+// reach bitsets, then each half is solved recursively, so only O(target)
+// bits are alive per recursion level and no 2D table is ever built.
+static void collectSubset(const vector<int>& coins, int first, int last, int target,
+                          vector<int>& chosen, vector<int>& rest) {
+    if (last - first == 1) {
+        if (target != 0 && coins[first] == target) {
+            chosen.push_back(first);
+        } else {
+            rest.push_back(first);
+        }
+        return;
     }
 
-    int n = items.size();
+    int mid = (first + last) / 2;
+    int leftTarget = 0;
+    {
+        vector<uint64_t> leftReach = buildReach(coins, first, mid, target);
+        vector<uint64_t> rightReach = buildReach(coins, mid, last, target);
+        for (int s = target; s >= 0; s--) {
+            if (testBit(leftReach, s) && testBit(rightReach, target - s)) {
+                leftTarget = s;
+                break;
+            }
+        }
+    } // free both bitsets before recursing
+
+    collectSubset(coins, first, mid, leftTarget, chosen, rest);
+    collectSubset(coins, mid, last, target - leftTarget, chosen, rest);
+}
 
-    vector<vector<int>> dp(n + 1, vector<int>(capacity + 1, 0));
+pair<vector<int>, vector<int>> InventorySystem::splitLootStacks(vector<int>& coins) {
+    int n = coins.size();
+    pair<vector<int>, vector<int>> stacks;
+    if (n == 0)
+        return stacks;
 
-    for (int i = 1; i <= n; i++) {
-        int weight = items[i-1].first;
-        int value = items[i-1].second;
+    long long totalSum = 0;
+    for (int x : coins)
+        totalSum += x;
 
-        for (int W = 0; W <= capacity; W++) {
-            if (weight > W) {
-                // can not take it so become similar to the  cell above it
-                dp[i][W] = dp[i-1][W];
+    long long halfCoins = totalSum / 2;
+    if (preferLootMeetInTheMiddle(n, halfCoins)) {
+        uint64_t mask;
+        lootSplitMeetInTheMiddle(coins, n, halfCoins, mask);
+        for (int i = 0; i < n; i++) {
+            if (mask >> i & 1) {
+                stacks.first.push_back(i);
             } else {
-                // take the maximum [ the cell above it OR  (value + dp[W- weight] ) ]
-                dp[i][W] = max(dp[i-1][W], value + dp[i-1][W - weight]);
+                stacks.second.push_back(i);
             }
         }
+        return stacks;
+    }
+    if (halfCoins > kLootBitsetMaxSum) {
+        vector<vector<int>> groups = karmarkarKarpSplit(coins, 2);
+        long long firstSum = 0;
+        for (int idx : groups[0]) firstSum += coins[idx];
+        if (2 * firstSum > totalSum) swap(groups[0], groups[1]);
+        return {groups[0], groups[1]};
     }
 
-    return dp[n][capacity];
-}
-
-long long InventorySystem::countStringPossibilities(string s) {
-    // TODO: Implement string decoding DP
-    // Rules: "uu" can be decoded as "w" or "uu"
-    //        "nn" can be decoded as "m" or "nn"
-    // Count total possible decodings
+    vector<uint64_t> reach = buildReach(coins, 0, n, halfCoins);
+    int best = 0;
+    for (int i = halfCoins; i >= 0; i--) {
+        if (testBit(reach, i)) {
+            best = i;
+            break;
+        }
+    }
 
-    const int MOD = 1000000007;
-    int n = s.length();
+    // first stack is the lighter one (sum == best)
+    collectSubset(coins, 0, n, best, stacks.first, stacks.second);
+    return stacks;
+}
 
-    for (char &character : s) {
-        character = tolower(character);
+// --- K-way loot split ---
+// Coins are tracked in per-player singly linked lists (next[]) so merging
+// two players' piles during Karmarkar-Karp is O(1)
+struct PartyPile {
+    long long sum;
+    int head;
+    int tail;
+};
 
+// One partial solution of the largest differencing method. Only non-empty
+// piles are stored (the other k - piles.size() are implied, with sum 0), so
+// all partials together hold at most one pile per coin
+struct PartyPartial {
+    vector<PartyPile> piles;
+    long long spread; // max - min pile sum over all k piles, cached for the heap
+
+    void updateSpread(int k) {
+        long long hi = LLONG_MIN, lo = (int)piles.size() < k ? 0 : LLONG_MAX;
+        for (auto& p : piles) {
+            hi = max(hi, p.sum);
+            lo = min(lo, p.sum);
+        }
+        spread = hi - lo;
     }
+};
 
-    //invalid input (keyboard is broken , cannot product 'w' pr 'm')
-    for (char character : s) {
-        if (character == 'w' || character == 'm') {
-            return 0;
+static vector<vector<int>> collectPiles(const vector<PartyPile>& piles, const vector<int>& next, int k) {
+    vector<vector<int>> groups(k);
+    for (size_t i = 0; i < piles.size(); i++) {
+        for (int c = piles[i].head; c != -1; c = next[c]) {
+            groups[i].push_back(c);
         }
     }
+    return groups;
+}
 
-    //initialize all array element = 0 as initial values
-    vector<long long> dp(n + 1, 0);
-
-    //index 0 , 1 its values always 1
-    dp[0] = 1;                   // this handles empty inputs (there is one way : do nothing)
-    dp[1] = 1;                   // handle one character which has only one way : it self only
+static long long groupsSpread(const vector<vector<int>>& groups, const vector<int>& coins) {
+    long long hi = LLONG_MIN, lo = LLONG_MAX;
+    for (auto& g : groups) {
+        long long sum = 0;
+        for (int c : g) sum += coins[c];
+        hi = max(hi, sum);
+        lo = min(lo, sum);
+    }
+    return hi - lo;
+}
 
-    for (int i = 2; i <= n; i++) {
-        dp[i] = dp[i - 1];
+// Multi-way Karmarkar-Karp: repeatedly merge the two partials with the
+// largest spread, pairing the heaviest piles of one with the lightest of
+// the other. The heap holds partial indices, so partials are moved into
+// each other and never copied. O(n k log k + n log n)
+static vector<vector<int>> karmarkarKarpSplit(const vector<int>& coins, int k) {
+    int n = coins.size();
+    if (n == 0) {
+        return vector<vector<int>>(k);
+    }
+    vector<int> next(n, -1);
+    vector<PartyPartial> partials(n);
+    priority_queue<pair<long long, int>> bySpread; // (spread, partial)
+    for (int i = 0; i < n; i++) {
+        partials[i].piles = {{coins[i], i, i}};
+        partials[i].updateSpread(k);
+        bySpread.push({partials[i].spread, i});
+    }
 
-        if ((s[i - 2] == 'u' && s[i - 1] == 'u') ||
-            (s[i - 2] == 'n' && s[i - 1] == 'n')) {
-            dp[i] = (dp[i] + dp[i - 2]) % MOD;
+    auto heavy = [](const PartyPile& x, const PartyPile& y) { return x.sum > y.sum; };
+    auto light = [](const PartyPile& x, const PartyPile& y) { return x.sum < y.sum; };
+    while (bySpread.size() > 1) {
+        PartyPartial& a = partials[bySpread.top().second];
+        bySpread.pop();
+        int bIndex = bySpread.top().second;
+        bySpread.pop();
+        vector<PartyPile> b = move(partials[bIndex].piles);
+
+        // a's piles heaviest first, then its implied empty ones; b's implied
+        // empty piles lightest first, then its own piles: b[j] meets a[k - |b| + j]
+        sort(a.piles.begin(), a.piles.end(), heavy);
+        sort(b.begin(), b.end(), light);
+        size_t filled = a.piles.size();
+        for (size_t j = 0; j < b.size(); j++) {
+            size_t into = k - b.size() + j;
+            if (into >= filled) {
+                a.piles.push_back(b[j]);
+            } else {
+                next[a.piles[into].tail] = b[j].head;
+                a.piles[into].tail = b[j].tail;
+                a.piles[into].sum += b[j].sum;
+            }
         }
+        a.updateSpread(k);
+        bySpread.push({a.spread, (int)(&a - partials.data())});
     }
-
-    return dp[n];
+    return collectPiles(partials[bySpread.top().second].piles, next, k);
 }
 
-// =========================================================
-// PART C: WORLD NAVIGATOR (Graphs)
-// =========================================================
-bool WorldNavigator::pathExists(int n, vector<vector<int>>& edges, int source, int dest) {
-    // Implement path existence check using BFS or DFS
-    if (source == dest)
-        return true;
-    // Build pairs list
-    vector<vector<int>> pairs(n);
-    for (auto& e : edges) {
-        int u = e[0];
-        int v = e[1];
-        // make all pairs
-        pairs[u].push_back(v);
-        pairs[v].push_back(u);  // bidirectional
+// Largest processing time first: the `sorted` largest coins in decreasing
+// order, then the middle in input order, then the `sorted` smallest in
+// decreasing order, each onto the lightest pile. Only the two ends are
+// sorted (after O(n) selections), so this stays cheap enough for inputs
+// where Karmarkar-Karp would miss the deadline
+static vector<vector<int>> largestFirstSplit(const vector<int>& coins, int k, size_t sorted) {
+    vector<int> order(coins.size());
+    iota(order.begin(), order.end(), 0);
+    auto larger = [&](int a, int b) { return coins[a] > coins[b]; };
+    if (2 * sorted < order.size()) {
+        // only the largest and the smallest coins are sorted; the middle
+        // goes in input order and the small tail evens the piles out
+        nth_element(order.begin(), order.begin() + sorted, order.end(), larger);
+        nth_element(order.begin() + sorted, order.end() - sorted, order.end(), larger);
+        sort(order.begin(), order.begin() + sorted, larger);
+        sort(order.end() - sorted, order.end(), larger);
+    } else {
+        sort(order.begin(), order.end(), larger);
     }
-    // BFS
-    vector visited(n, false);
-    queue<int> q;
 
-    visited[source] = true;
-    q.push(source);
+    vector<vector<int>> groups(k);
+    priority_queue<pair<long long, int>, vector<pair<long long, int>>, greater<pair<long long, int>>> lightest;
+    for (int g = 0; g < k; g++) {
+        lightest.push({0, g});
+    }
+    for (int c : order) {
+        auto [sum, g] = lightest.top();
+        lightest.pop();
+        groups[g].push_back(c);
+        lightest.push({sum + coins[c], g});
+    }
+    return groups;
+}
 
-    while (!q.empty())
-    {
-        int u = q.front();
-        q.pop();
-        for (auto& v : pairs[u])
-        {
-            if (!visited[v])
-            {
-                if (v == dest)
-                    return true;
-                q.push(v);
-                visited[v] = true;
+// Exact branch and bound for small inputs: place coins (largest first)
+// into piles, skipping piles with equal sums, and prune with the spread
+// lower bound. Stops at the deadline keeping the best split found.
+class PartySplitSearch {
+private:
+    const vector<int>& coins;
+    vector<int> order;       // coin indices, largest first
+    vector<long long> suffix; // suffix[i] = sum of coins order[i..]
+    vector<long long> sums;
+    vector<int> assignment;   // pile of order[i]
+    vector<int> bestAssignment;
+    long long bestSpread;
+    long long idealHigh, idealLow;
+    chrono::steady_clock::time_point deadline;
+    long long nodes;
+    bool timedOut;
+
+    void search(int i) {
+        if (timedOut) return;
+        if ((++nodes & 1023) == 0 && chrono::steady_clock::now() >= deadline) {
+            timedOut = true;
+            return;
+        }
+
+        long long hi = *max_element(sums.begin(), sums.end());
+        long long lo = *min_element(sums.begin(), sums.end());
+        if (i == (int)order.size()) {
+            if (hi - lo < bestSpread) {
+                bestSpread = hi - lo;
+                bestAssignment = assignment;
             }
+            return;
+        }
+        // Final max is at least max(hi, ideal), final min at most min(lo + rest, ideal)
+        long long bound = max(hi, idealHigh) - min(lo + suffix[i], idealLow);
+        if (bound >= bestSpread) return;
+
+        set<long long> tried;
+        for (size_t p = 0; p < sums.size() && bestSpread > 0; p++) {
+            if (!tried.insert(sums[p]).second) continue; // same sum, same subtree
+            sums[p] += coins[order[i]];
+            assignment[i] = p;
+            search(i + 1);
+            sums[p] -= coins[order[i]];
         }
     }
-    // edges are bidirectional
-    return false;
-}
-
-struct Edge {
-    int to;
-    long long goldCost;
-    long long silverCost;
-};
 
-long long WorldNavigator::minBribeCost(int n, int m, long long goldRate, long long silverRate, vector<vector<int>>& roadData) {
-    // Implement Minimum Spanning Tree (Kruskal's or Prim's)
-    // roadData[i] = {u, v, goldCost, silverCost}
-    // Build adjacency list
-    vector<vector<Edge>> adj(n);
-    for (auto &r : roadData) {
-        int u = r[0];
-        int v = r[1];
-        long long goldCost = r[2];
-        long long silverCost = r[3];
-        // bidirectional
-        adj[u].push_back({v, goldCost, silverCost});
-        adj[v].push_back({u, goldCost, silverCost});
+public:
+    PartySplitSearch(const vector<int>& coins, int k, chrono::steady_clock::time_point deadline)
+        : coins(coins), sums(k, 0), bestSpread(LLONG_MAX), deadline(deadline), nodes(0), timedOut(false) {
+        order.resize(coins.size());
+        iota(order.begin(), order.end(), 0);
+        sort(order.begin(), order.end(), [&](int a, int b) { return coins[a] > coins[b]; });
+        suffix.assign(order.size() + 1, 0);
+        for (int i = order.size() - 1; i >= 0; i--) {
+            suffix[i] = suffix[i + 1] + coins[order[i]];
+        }
+        idealLow = suffix[0] / k;
+        idealHigh = (suffix[0] + k - 1) / k;
+        assignment.assign(order.size(), 0);
     }
 
-    // Min-heap: (cost, vertex)
-    using P = pair<long long, int>; // cost, vertex
-    priority_queue<P, vector<P>, greater<P>> pq;
+    // Improves on `seed` if possible; returns the better of the two
+    vector<vector<int>> solve(const vector<vector<int>>& seed) {
+        bestSpread = groupsSpread(seed, coins);
+        search(0);
+        if (bestAssignment.empty()) return seed;
 
-    vector inMST(n, false);
-    vector minCost(n, LLONG_MAX);
-    vector<long long> minGold(n, 0);
-    vector<long long> minSilver(n, 0);
+        vector<vector<int>> groups(sums.size());
+        for (size_t i = 0; i < order.size(); i++) {
+            groups[bestAssignment[i]].push_back(order[i]);
+        }
+        return groups;
+    }
+};
 
-    minCost[0] = 0;
-    pq.push({0, 0});
+// Refinement for large inputs: re-split the union of the heaviest and a
+// light pile exactly with the two-way bitset partition while time remains.
+// A re-split is only attempted when its estimated cost fits the time left.
+static void refinePartySplit(vector<vector<int>>& groups, const vector<int>& coins,
+                             chrono::steady_clock::time_point deadline) {
+    const long long maxPairSum = 1LL << 26; // keeps the two-way bitset at <= 4MB
+    const double wordOpsPerMs = 2e5;       // conservative shift-or throughput
+    int k = groups.size();
+    vector<long long> sums(k, 0);
+    for (int g = 0; g < k; g++) {
+        for (int c : groups[g]) sums[g] += coins[c];
+    }
 
-    long long totalGold = 0, totalSilver = 0;
-    int count = 0;
+    bool improved = true;
+    while (improved && chrono::steady_clock::now() < deadline) {
+        improved = false;
+        vector<int> byWeight(k);
+        iota(byWeight.begin(), byWeight.end(), 0);
+        sort(byWeight.begin(), byWeight.end(), [&](int a, int b) { return sums[a] > sums[b]; });
+
+        int heavy = byWeight[0];
+        // pair the heaviest pile with the lightest one that it can improve
+        for (int j = k - 1; j > 0 && !improved; j--) {
+            int lightPile = byWeight[j];
+            long long pairSum = sums[heavy] + sums[lightPile];
+            if (pairSum > maxPairSum) continue;
+
+            // splitLootStacks does ~members * (sum/2 / 64) word ops per recursion level
+            double memberCount = groups[heavy].size() + groups[lightPile].size();
+            double cost = memberCount * (pairSum / 128.0 + 1) * (log2(memberCount) + 1);
+            double msLeft = chrono::duration<double, milli>(deadline - chrono::steady_clock::now()).count();
+            if (cost > msLeft * wordOpsPerMs) continue;
+
+            vector<int> members = groups[heavy];
+            members.insert(members.end(), groups[lightPile].begin(), groups[lightPile].end());
+            vector<int> values;
+            for (int c : members) values.push_back(coins[c]);
+
+            auto halves = InventorySystem::splitLootStacks(values);
+            long long lighter = 0;
+            for (int idx : halves.first) lighter += values[idx];
+            // only accept if the heavy pile gets lighter
+            if (pairSum - lighter >= sums[heavy]) continue;
+
+            groups[heavy].clear();
+            groups[lightPile].clear();
+            for (int idx : halves.second) groups[heavy].push_back(members[idx]);
+            for (int idx : halves.first) groups[lightPile].push_back(members[idx]);
+            sums[heavy] = pairSum - lighter;
+            sums[lightPile] = lighter;
+            improved = true;
+        }
+    }
+}
 
-    while (!pq.empty()) {
-        auto [cost, u] = pq.top();
-        pq.pop();
-        if (inMST[u])
-            continue;
+// Karmarkar-Karp cost per coin and pile (times log k), in ns; about twice
+// what it measures at 100k coins among 40 players
+static const double kPartyDifferencingNsPerPile = 10;
+// Largest-first sorts this many of the biggest (and smallest) coins per player
+static const size_t kPartyLargestFirstSortedPerPlayer = 64;
 
-        inMST[u] = true;
-        totalGold += minGold[u];
-        totalSilver += minSilver[u];
-        count++;
+vector<vector<int>> InventorySystem::splitLootAmongParty(vector<int>& coins, int players, int timeBudgetMs) {
+    if (players <= 0) {
+        return {};
+    }
+    auto deadline = chrono::steady_clock::now() + chrono::milliseconds(max(0, timeBudgetMs));
+
+    // Largest differencing gives the better starting split, but costs about
+    // n k log k; when that would eat more than half the budget, start from
+    // largest-first instead and leave the rest of the time to refinement
+    double n = coins.size();
+    double differencingMs = n * players * (log2(players) + 1) * kPartyDifferencingNsPerPile / 1e6;
+    vector<vector<int>> groups = differencingMs <= timeBudgetMs / 2.0
+        ? karmarkarKarpSplit(coins, players)
+        : largestFirstSplit(coins, players, kPartyLargestFirstSortedPerPlayer * players);
+    if (players == 1 || groupsSpread(groups, coins) == 0) {
+        return groups;
+    }
 
-        for (auto &e : adj[u]) {
-            int v = e.to;
-            long long edgeCost = e.goldCost * goldRate + e.silverCost * silverRate;
+    const int exactLimit = 24; // coins; beyond this the exact search rarely finishes
+    if ((int)coins.size() <= exactLimit) {
+        return PartySplitSearch(coins, players, deadline).solve(groups);
+    }
+    refinePartySplit(groups, coins, deadline);
+    return groups;
+}
 
-            if (!inMST[v] && edgeCost < minCost[v]) {
-                minCost[v] = edgeCost;
-                minGold[v] = e.goldCost;
-                minSilver[v] = e.silverCost;
-                pq.push({edgeCost, v});
-            }
-        }
+// --- 0/1 knapsack row kernels ---
+// dp[W] = max(dp[W], dp[W - weight] + value) for W = to down to weight.
+// Blocks are processed top-down and each block loads its sources before
+// storing; every lower index still holds the previous row, so the single
+// rolling row stays a correct 0/1 update for any weight.
+typedef void (*KnapsackRowKernel)(int* dp, int weight, int value, int to);
+
+static void knapsackRowScalar(int* dp, int weight, int value, int to) {
+    for (int W = to; W >= weight; W--) {
+        dp[W] = max(dp[W], dp[W - weight] + value);
     }
+}
 
-    if (count != n)
-        return -1;
-    return totalGold * goldRate + totalSilver * silverRate;
-    // Total cost = goldCost * goldRate + silverCost * silverRate
-    // Return -1 if graph cannot be fully connected
+#ifdef ARCADIA_X86_SIMD
+__attribute__((target("avx2")))
+static void knapsackRowAVX2(int* dp, int weight, int value, int to) {
+    __m256i v = _mm256_set1_epi32(value);
+    int W = to;
+    for (; W - 7 >= weight; W -= 8) {
+        __m256i skip = _mm256_loadu_si256((const __m256i*)(dp + W - 7));
+        __m256i take = _mm256_add_epi32(_mm256_loadu_si256((const __m256i*)(dp + W - 7 - weight)), v);
+        _mm256_storeu_si256((__m256i*)(dp + W - 7), _mm256_max_epi32(skip, take));
+    }
+    knapsackRowScalar(dp, weight, value, W);
 }
 
-string decimalToBinary(long long num){
-    if (num == 0)
-        return "0";
-    string bits = "";
-    while (num > 0){
-        int remainder = num % 2;
-        bits = (remainder ? '1' : '0') + bits;
-        num = num / 2;
+// GCC 12's avx512fintrin.h passes a deliberately undefined vector as the
+// masked intrinsics' passthrough and then reports it as maybe-uninitialized
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+__attribute__((target("avx512f")))
+static void knapsackRowAVX512(int* dp, int weight, int value, int to) {
+    __m512i v = _mm512_set1_epi32(value);
+    int W = to;
+    for (; W - 15 >= weight; W -= 16) {
+        __m512i skip = _mm512_loadu_si512((const void*)(dp + W - 15));
+        __m512i take = _mm512_add_epi32(_mm512_loadu_si512((const void*)(dp + W - 15 - weight)), v);
+        _mm512_storeu_si512((void*)(dp + W - 15), _mm512_max_epi32(skip, take));
     }
-    return bits;
+    knapsackRowScalar(dp, weight, value, W);
+}
+#pragma GCC diagnostic pop
+#endif
+
+// Widest row kernel the CPU supports
+static KnapsackRowKernel knapsackRowKernel() {
+#ifdef ARCADIA_X86_SIMD
+    if (cpuHasAVX512()) return knapsackRowAVX512;
+    if (cpuHasAVX2()) return knapsackRowAVX2;
+#endif
+    return knapsackRowScalar;
 }
 
-string binaryAdd(string a, string b){
-    int n = a.size(), m = b.size();
-    // Pad shorter string with zeros
-    if (n < m) a = string(m-n, '0') + a;
-    if (m < n) b = string(n-m, '0') + b;
+// Out-of-place variant for the parallel DP: cur[W] for W in [from, to)
+// is computed from the previous row only (callers keep W >= weight)
+typedef void (*KnapsackRowIntoKernel)(const int* prev, int* cur, int weight, int value, int from, int to);
 
-    string result = "";
-    int carry = 0;
-    for (int i = a.size()-1; i >= 0; i--){
-        int bitA = a[i]-'0';
-        int bitB = b[i]-'0';
-        int sum = bitA + bitB + carry;
-        result = char((sum % 2) + '0') + result;
-        carry = sum / 2;
+static void knapsackRowIntoScalar(const int* prev, int* cur, int weight, int value, int from, int to) {
+    for (int W = from; W < to; W++) {
+        cur[W] = max(prev[W], prev[W - weight] + value);
     }
-    if (carry) result = '1' + result;
-    return result;
 }
 
-string WorldNavigator::sumMinDistancesBinary(int n, vector<vector<int>>& roads) {
-    // Implement All-Pairs Shortest Path (Floyd-Warshall)
-    // Sum all shortest distances between unique pairs (i < j)
-    long long dist[n][n];
-    string sumBinary = "0";
-    for (int i = 0 ; i < n; i++)
+#ifdef ARCADIA_X86_SIMD
+__attribute__((target("avx2")))
+static void knapsackRowIntoAVX2(const int* prev, int* cur, int weight, int value, int from, int to) {
+    __m256i v = _mm256_set1_epi32(value);
+    int W = from;
+    for (; W + 8 <= to; W += 8) {
+        __m256i skip = _mm256_loadu_si256((const __m256i*)(prev + W));
+        __m256i take = _mm256_add_epi32(_mm256_loadu_si256((const __m256i*)(prev + W - weight)), v);
+        _mm256_storeu_si256((__m256i*)(cur + W), _mm256_max_epi32(skip, take));
+    }
+    knapsackRowIntoScalar(prev, cur, weight, value, W, to);
+}
+
+// Same GCC 12 false positive as knapsackRowAVX512
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+__attribute__((target("avx512f")))
+static void knapsackRowIntoAVX512(const int* prev, int* cur, int weight, int value, int from, int to) {
+    __m512i v = _mm512_set1_epi32(value);
+    int W = from;
+    for (; W + 16 <= to; W += 16) {
+        __m512i skip = _mm512_loadu_si512((const void*)(prev + W));
+        __m512i take = _mm512_add_epi32(_mm512_loadu_si512((const void*)(prev + W - weight)), v);
+        _mm512_storeu_si512((void*)(cur + W), _mm512_max_epi32(skip, take));
+    }
+    knapsackRowIntoScalar(prev, cur, weight, value, W, to);
+}
+#pragma GCC diagnostic pop
+#endif
+
+static KnapsackRowIntoKernel knapsackRowIntoKernel() {
+#ifdef ARCADIA_X86_SIMD
+    if (cpuHasAVX512()) return knapsackRowIntoAVX512;
+    if (cpuHasAVX2()) return knapsackRowIntoAVX2;
+#endif
+    return knapsackRowIntoScalar;
+}
+
+int InventorySystem::maximizeCarryValue(int capacity, vector<pair<int, int>>& items) {
+    // 0/1 Knapsack using DP
+    // items = {weight, value} pairs
+    // Return maximum value achievable within capacity
+    // Only one row of O(capacity) is kept; each item updates it in place
+    // from the highest capacity down
+
+    if (items.empty() || capacity <= 0) {
+        return 0;
+    }
+
+    vector<int> dp(capacity + 1, 0);
+    KnapsackRowKernel updateRow = knapsackRowKernel();
+
+    for (auto& item : items) {
+        int weight = item.first;
+        int value = item.second;
+        if (weight < 0 || weight > capacity) {
+            continue; // can never be taken
+        }
+        updateRow(dp.data(), weight, value, capacity);
+    }
+
+    return dp[capacity];
+}
+
+// Best value for every capacity 0..capacity using items[first..last)
+static vector<int> knapsackRow(const vector<pair<int, int>>& items, int first, int last, int capacity) {
+    vector<int> dp(capacity + 1, 0);
+    KnapsackRowKernel updateRow = knapsackRowKernel();
+    for (int i = first; i < last; i++) {
+        int weight = items[i].first;
+        if (weight < 0 || weight > capacity) continue;
+        updateRow(dp.data(), weight, items[i].second, capacity);
+    }
+    return dp;
+}
+
+// Divide and conquer over items: split the capacity between the two
+// halves where their best rows add up to the optimum, then recurse.
+// Only O(capacity) ints per level are alive, never an n x W table.
+static void collectCarryItems(const vector<pair<int, int>>& items, int first, int last,
+                              int capacity, vector<int>& chosen) {
+    if (last - first == 1) {
+        int weight = items[first].first;
+        if (weight >= 0 && weight <= capacity && items[first].second > 0) {
+            chosen.push_back(first);
+        }
+        return;
+    }
+
+    int mid = (first + last) / 2;
+    int leftCapacity = 0;
     {
-        for (int j = 0 ; j < n; j++)
-        {
-            if (i == j)
-                dist[i][j] = 0;
-            else
-                dist [i][j] = LLONG_MAX;
+        vector<int> leftRow = knapsackRow(items, first, mid, capacity);
+        vector<int> rightRow = knapsackRow(items, mid, last, capacity);
+        int best = -1;
+        for (int c = 0; c <= capacity; c++) {
+            if (leftRow[c] + rightRow[capacity - c] > best) {
+                best = leftRow[c] + rightRow[capacity - c];
+                leftCapacity = c;
+            }
+        }
+    } // free both rows before recursing
+
+    collectCarryItems(items, first, mid, leftCapacity, chosen);
+    collectCarryItems(items, mid, last, capacity - leftCapacity, chosen);
+}
+
+vector<int> InventorySystem::selectCarryItems(int capacity, vector<pair<int, int>>& items) {
+    vector<int> chosen;
+    if (items.empty() || capacity <= 0) {
+        return chosen;
+    }
+    collectCarryItems(items, 0, items.size(), capacity, chosen);
+    return chosen;
+}
+
+int InventorySystem::maximizeCarryValueParallel(int capacity, vector<pair<int, int>>& items, int threads) {
+    // Same DP, but each item's row update is split by capacity range across
+    // threads. Rows are double-buffered since a thread reads dp[W - weight]
+    // from other threads' ranges; a barrier separates consecutive items.
+    if (items.empty() || capacity <= 0) {
+        return 0;
+    }
+
+    int workers = min(resolveThreadCount(threads), capacity + 1);
+    vector<int> rows[2] = {vector<int>(capacity + 1, 0), vector<int>(capacity + 1, 0)};
+    ThreadBarrier barrier(workers);
+    KnapsackRowIntoKernel updateRange = knapsackRowIntoKernel();
+
+    auto work = [&](int t) {
+        int lo = (long long)(capacity + 1) * t / workers;
+        int hi = (long long)(capacity + 1) * (t + 1) / workers;
+        for (size_t i = 0; i < items.size(); i++) {
+            const int* prev = rows[i % 2].data();
+            int* cur = rows[(i + 1) % 2].data();
+            int weight = items[i].first;
+            int value = items[i].second;
+            bool usable = weight >= 0 && weight <= capacity;
+
+            // below the item's weight the row is unchanged
+            int split = usable ? min(max(lo, weight), hi) : hi;
+            copy(prev + lo, prev + split, cur + lo);
+            if (split < hi) {
+                updateRange(prev, cur, weight, value, split, hi);
+            }
+            barrier.arriveAndWait();
+        }
+    };
+
+    vector<thread> pool;
+    for (int t = 1; t < workers; t++) {
+        pool.emplace_back(work, t);
+    }
+    work(0);
+    for (auto& worker : pool) {
+        worker.join();
+    }
+
+    return rows[items.size() % 2][capacity];
+}
+
+// --- Adaptive knapsack solvers ---
+// All of them expect items with 0 < weight <= capacity and value > 0
+
+// Min weight for every total value 0..sumValues: O(n * sumValues)
+static long long knapsackByValue(const vector<pair<int, int>>& items, long long capacity) {
+    long long sumValues = 0;
+    for (auto& item : items) sumValues += item.second;
+
+    vector<long long> minWeight(sumValues + 1, LLONG_MAX);
+    minWeight[0] = 0;
+    long long reached = 0; // highest value with a finite weight so far
+    for (auto& item : items) {
+        int weight = item.first;
+        int value = item.second;
+        for (long long v = reached; v >= 0; v--) {
+            if (minWeight[v] != LLONG_MAX && minWeight[v] + weight < minWeight[v + value]) {
+                minWeight[v + value] = minWeight[v] + weight;
+            }
+        }
+        reached += value;
+    }
+
+    for (long long v = sumValues; v > 0; v--) {
+        if (minWeight[v] <= capacity) return v;
+    }
+    return 0;
+}
+
+// All (weight, value) subset sums of items[first..last)
+static vector<pair<long long, long long>> subsetSums(const vector<pair<int, int>>& items, int first, int last) {
+    vector<pair<long long, long long>> sums = {{0, 0}};
+    sums.reserve(1LL << (last - first));
+    for (int i = first; i < last; i++) {
+        size_t count = sums.size();
+        for (size_t j = 0; j < count; j++) {
+            sums.push_back({sums[j].first + items[i].first, sums[j].second + items[i].second});
+        }
+    }
+    return sums;
+}
+
+// Meet in the middle: enumerate both halves, keep the right half's
+// Pareto frontier sorted by weight and binary search it per left subset.
+// O(2^(n/2) * n) time, O(2^(n/2)) memory
+static long long knapsackMeetInTheMiddle(const vector<pair<int, int>>& items, long long capacity) {
+    int n = items.size();
+    int mid = n / 2;
+    vector<pair<long long, long long>> left = subsetSums(items, 0, mid);
+    vector<pair<long long, long long>> right = subsetSums(items, mid, n);
+
+    sort(right.begin(), right.end());
+    vector<pair<long long, long long>> frontier; // weight up, value strictly up
+    for (auto& s : right) {
+        if (s.first > capacity) break;
+        if (frontier.empty() || s.second > frontier.back().second) {
+            if (!frontier.empty() && frontier.back().first == s.first) {
+                frontier.back().second = s.second;
+            } else {
+                frontier.push_back(s);
+            }
+        }
+    }
+
+    long long best = 0;
+    for (auto& s : left) {
+        if (s.first > capacity) continue;
+        long long room = capacity - s.first;
+        // last frontier entry with weight <= room
+        auto it = upper_bound(frontier.begin(), frontier.end(), make_pair(room, LLONG_MAX));
+        if (it == frontier.begin()) continue;
+        best = max(best, s.second + prev(it)->second);
+    }
+    return best;
+}
+
+// Depth-first branch and bound over items sorted by value density, pruned
+// with the LP-relaxation (fractional knapsack) bound. Exponential in the
+// worst case, used when neither DP table fits. The search keeps its own
+// stack, so depth (one level per item) is not limited by the call stack
+class KnapsackBranchAndBound {
+private:
+    struct Node {
+        int i;           // next item to decide
+        long long weight;
+        long long value;
+    };
+
+    vector<pair<int, int>> items;    // sorted by value / weight, descending
+    vector<long long> prefixWeight;  // prefixWeight[i] = weight of items[0..i)
+    vector<long long> prefixValue;
+    long long capacity;
+    long long best;
+
+    // Upper bound for items[i..) with the given room, fractional last item
+    double bound(int i, long long room) {
+        int n = items.size();
+        // last k such that items[i..k) all fit
+        long long base = prefixWeight[i];
+        int k = upper_bound(prefixWeight.begin() + i, prefixWeight.end(), base + room) - prefixWeight.begin() - 1;
+        double value = prefixValue[k] - prefixValue[i];
+        long long left = room - (prefixWeight[k] - base);
+        if (k < n) {
+            value += (double)left * items[k].second / items[k].first;
+        }
+        return value;
+    }
+
+
+public:
+    KnapsackBranchAndBound(const vector<pair<int, int>>& input, long long capacity)
+        : items(input), capacity(capacity), best(0) {
+        sort(items.begin(), items.end(), [](const pair<int, int>& a, const pair<int, int>& b) {
+            return (long long)a.second * b.first > (long long)b.second * a.first;
+        });
+        prefixWeight.assign(items.size() + 1, 0);
+        prefixValue.assign(items.size() + 1, 0);
+        for (size_t i = 0; i < items.size(); i++) {
+            prefixWeight[i + 1] = prefixWeight[i] + items[i].first;
+            prefixValue[i + 1] = prefixValue[i] + items[i].second;
+        }
+    }
+
+    // Best value, or -1 if nodeLimit nodes were visited without finishing
+    long long solve(long long nodeLimit) {
+        // greedy by density gives a good first incumbent
+        long long room = capacity;
+        for (auto& item : items) {
+            if (item.first <= room) {
+                room -= item.first;
+                best += item.second;
+            }
+        }
+
+        int n = items.size();
+        vector<Node> stack = {{0, 0, 0}};
+        long long visited = 0;
+        while (!stack.empty()) {
+            if (++visited > nodeLimit) return -1;
+            Node node = stack.back();
+            stack.pop_back();
+            if (node.value > best) best = node.value;
+            if (node.i == n) continue;
+            if (node.value + bound(node.i, capacity - node.weight) <= best) continue;
+
+            // skip goes on first so the take branch is explored first
+            int weight = items[node.i].first;
+            int value = items[node.i].second;
+            stack.push_back({node.i + 1, node.weight, node.value});
+            if (node.weight + weight <= capacity) {
+                stack.push_back({node.i + 1, node.weight + weight, node.value + value});
+            }
+        }
+        return best;
+    }
+};
+
+// Branch and bound gives up after this many search nodes (~0.3s)
+static const long long kBranchAndBoundNodeLimit = 10000000;
+// and then enumerates halves if they hold at most 2^22 subsets each
+static const size_t kMeetInTheMiddleFallbackItems = 44;
+
+long long InventorySystem::maximizeCarryValueAdaptive(long long capacity, vector<pair<int, int>>& items,
+                                                      KnapsackStrategy strategy) {
+    // Drop items that can never be packed and always take free ones
+    vector<pair<int, int>> useful;
+    long long freeValue = 0;
+    long long sumValues = 0;
+    for (auto& item : items) {
+        if (item.second <= 0 || item.first < 0 || item.first > capacity) continue;
+        if (item.first == 0) {
+            freeValue += item.second;
+            continue;
+        }
+        useful.push_back(item);
+        sumValues += item.second;
+    }
+    if (useful.empty() || capacity <= 0) {
+        return freeValue;
+    }
+
+    // DP tables must fit in memory, and the capacity DP works in int
+    const double tableLimit = 1e8;  // entries
+    bool capacityFits = capacity <= INT_MAX - 1 && sumValues <= INT_MAX && capacity + 1 <= tableLimit;
+    bool valueFits = sumValues + 1 <= tableLimit;
+    bool halvesFit = useful.size() <= 40;
+
+    if (strategy == KnapsackStrategy::Auto) {
+        // Pick the cheapest solver by estimated work
+        const double workLimit = 2e9;   // cell updates
+        double n = useful.size();
+        double capacityWork = capacityFits ? n * (capacity + 1) : 1e300;
+        double valueWork = valueFits ? n * (sumValues + 1) : 1e300;
+        double mitmWork = halvesFit ? ldexp(1.0, (useful.size() + 1) / 2) * n : 1e300;
+
+        double bestWork = min({capacityWork, valueWork, mitmWork});
+        if (bestWork > workLimit) {
+            strategy = KnapsackStrategy::BranchAndBound;
+        } else if (bestWork == capacityWork) {
+            strategy = KnapsackStrategy::CapacityDP;
+        } else if (bestWork == valueWork) {
+            strategy = KnapsackStrategy::ValueDP;
+        } else {
+            strategy = KnapsackStrategy::MeetInTheMiddle;
+        }
+    } else if ((strategy == KnapsackStrategy::CapacityDP && !capacityFits) ||
+               (strategy == KnapsackStrategy::ValueDP && !valueFits) ||
+               (strategy == KnapsackStrategy::MeetInTheMiddle && !halvesFit)) {
+        // a forced solver gets the same limits Auto respects
+        throw "Strategy does not fit this input";
+    }
+
+    switch (strategy) {
+        case KnapsackStrategy::CapacityDP:
+            return freeValue + knapsackRow(useful, 0, useful.size(), capacity)[capacity];
+        case KnapsackStrategy::ValueDP:
+            return freeValue + knapsackByValue(useful, capacity);
+        case KnapsackStrategy::MeetInTheMiddle:
+            return freeValue + knapsackMeetInTheMiddle(useful, capacity);
+        default: {
+            long long best = KnapsackBranchAndBound(useful, capacity).solve(kBranchAndBoundNodeLimit);
+            if (best >= 0) return freeValue + best;
+            // The bound is not pruning (equal value densities do this); just
+            // past Auto's cutoff, enumerating both halves is still cheaper
+            if (useful.size() <= kMeetInTheMiddleFallbackItems) {
+                return freeValue + knapsackMeetInTheMiddle(useful, capacity);
+            }
+            throw "Knapsack search budget exceeded";
+        }
+    }
+}
+
+// --- Prepared item sets ---
+PreparedItemSet::PreparedItemSet(const vector<pair<int, int>>& items, int maxCapacity)
+    : itemList(items), totalWeight(0) {
+    for (auto& item : items) {
+        if (item.first > 0) totalWeight += item.first;
+    }
+    // Past the total weight every item fits, so the row can stop there
+    preparedCapacity = max(0, maxCapacity);
+    int rowCapacity = (int)min<long long>(preparedCapacity, totalWeight);
+    best = knapsackRow(itemList, 0, itemList.size(), rowCapacity);
+}
+
+int PreparedItemSet::bestValue(int capacity) const {
+    // same rule as maximizeCarryValue: an empty bag holds nothing, even weightless items
+    if (capacity <= 0) return 0;
+    if (capacity < (int)best.size()) return best[capacity];
+    // Beyond the row the answer is only known once the row covers every item
+    if ((long long)best.size() - 1 == totalWeight) return best.back();
+    throw "Capacity not prepared";
+}
+
+int PreparedItemSet::maxCapacity() const {
+    return preparedCapacity;
+}
+
+const vector<pair<int, int>>& PreparedItemSet::items() const {
+    return itemList;
+}
+
+// LRU cache of prepared sets, most recently used at the front
+static const size_t kPreparedSetCacheSize = 16;
+static mutex preparedSetLock;
+static list<shared_ptr<const PreparedItemSet>> preparedSetOrder;
+static unordered_map<unsigned long long, list<shared_ptr<const PreparedItemSet>>::iterator> preparedSetIndex;
+
+static unsigned long long hashItems(const vector<pair<int, int>>& items) {
+    // FNV-1a over the (weight, value) pairs
+    unsigned long long h = 1469598103934665603ULL;
+    for (auto& item : items) {
+        h = (h ^ (unsigned int)item.first) * 1099511628211ULL;
+        h = (h ^ (unsigned int)item.second) * 1099511628211ULL;
+    }
+    return h;
+}
+
+shared_ptr<const PreparedItemSet> InventorySystem::prepareItemSet(vector<pair<int, int>>& items, int maxCapacity) {
+    unsigned long long key = hashItems(items);
+    lock_guard<mutex> guard(preparedSetLock);
+
+    auto found = preparedSetIndex.find(key);
+    if (found != preparedSetIndex.end()) {
+        shared_ptr<const PreparedItemSet> cached = *found->second;
+        // Reuse only on a true match that was prepared far enough
+        if (cached->items() == items && cached->maxCapacity() >= maxCapacity) {
+            preparedSetOrder.splice(preparedSetOrder.begin(), preparedSetOrder, found->second);
+            return cached;
+        }
+        preparedSetOrder.erase(found->second);
+        preparedSetIndex.erase(found);
+    }
+
+    auto prepared = make_shared<const PreparedItemSet>(items, maxCapacity);
+    preparedSetOrder.push_front(prepared);
+    preparedSetIndex[key] = preparedSetOrder.begin();
+    if (preparedSetOrder.size() > kPreparedSetCacheSize) {
+        preparedSetIndex.erase(hashItems(preparedSetOrder.back()->items()));
+        preparedSetOrder.pop_back();
+    }
+    return prepared;
+}
+
+// --- Incremental knapsack ---
+IncrementalKnapsack::IncrementalKnapsack(int capacity)
+    : capacity(max(0, capacity)), best(max(0, capacity) + 1, 0), dirty(false) {}
+
+int IncrementalKnapsack::addItem(int weight, int value) {
+    items.push_back({weight, value});
+    alive.push_back(true);
+    if (!dirty && weight >= 0 && weight <= capacity) {
+        knapsackRowKernel()(best.data(), weight, value, capacity);
+    }
+    return items.size() - 1;
+}
+
+void IncrementalKnapsack::removeItem(int handle) {
+    if (handle < 0 || handle >= (int)items.size() || !alive[handle]) return;
+    alive[handle] = false;
+    dirty = true; // max is not invertible, so the row has to be rebuilt
+}
+
+int IncrementalKnapsack::bestValue() {
+    // same rule as maximizeCarryValue: an empty bag holds nothing, even weightless items
+    if (capacity <= 0) return 0;
+    if (dirty) {
+        vector<pair<int, int>> live;
+        for (size_t i = 0; i < items.size(); i++) {
+            if (alive[i]) live.push_back(items[i]);
+        }
+        best = knapsackRow(live, 0, live.size(), capacity);
+        dirty = false;
+    }
+    return best[capacity];
+}
+
+// Segment tree over query indices: every item is stored in the O(log Q)
+// nodes covering the queries it is alive for. A DFS applies a node's items
+// to a copy of its parent's row, so each item costs O(W) per node and only
+// one row per tree level is alive.
+static void replayNode(int node, int lo, int hi, const vector<vector<int>>& nodeItems,
+                       const vector<pair<int, int>>& items, vector<int>& row,
+                       vector<int>& answers, int capacity) {
+    vector<int> saved;
+    if (!nodeItems[node].empty()) {
+        saved = row;
+        KnapsackRowKernel updateRow = knapsackRowKernel();
+        for (int idx : nodeItems[node]) {
+            updateRow(row.data(), items[idx].first, items[idx].second, capacity);
+        }
+    }
+
+    if (hi - lo == 1) {
+        answers[lo] = row[capacity];
+    } else {
+        int mid = (lo + hi) / 2;
+        replayNode(2 * node, lo, mid, nodeItems, items, row, answers, capacity);
+        replayNode(2 * node + 1, mid, hi, nodeItems, items, row, answers, capacity);
+    }
+
+    if (!nodeItems[node].empty()) {
+        row.swap(saved);
+    }
+}
+
+static void assignInterval(int node, int lo, int hi, int from, int to, int item, vector<vector<int>>& nodeItems) {
+    if (to <= lo || hi <= from) return;
+    if (from <= lo && hi <= to) {
+        nodeItems[node].push_back(item);
+        return;
+    }
+    int mid = (lo + hi) / 2;
+    assignInterval(2 * node, lo, mid, from, to, item, nodeItems);
+    assignInterval(2 * node + 1, mid, hi, from, to, item, nodeItems);
+}
+
+vector<int> InventorySystem::replayInventory(int capacity, vector<vector<int>>& events) {
+    int T = events.size();
+    // Lifetime of every item measured in queries: alive for [firstQuery, endQuery)
+    vector<pair<int, int>> items;
+    vector<int> itemOfEvent(T, -1);
+    vector<int> firstQuery, endQuery;
+    int queries = 0;
+    for (int t = 0; t < T; t++) {
+        const vector<int>& e = events[t];
+        if (e[0] == 0) {
+            itemOfEvent[t] = items.size();
+            items.push_back({e[1], e[2]});
+            firstQuery.push_back(queries);
+            endQuery.push_back(-1);
+        } else if (e[0] == 1) {
+            int handle = e[1];
+            if (handle >= 0 && handle < T && itemOfEvent[handle] != -1 && endQuery[itemOfEvent[handle]] == -1) {
+                endQuery[itemOfEvent[handle]] = queries;
+            }
+        } else {
+            queries++;
+        }
+    }
+
+    vector<int> answers(queries, 0);
+    if (queries == 0 || capacity <= 0) return answers; // as maximizeCarryValue
+
+    vector<vector<int>> nodeItems(4 * queries);
+    for (size_t i = 0; i < items.size(); i++) {
+        if (items[i].first < 0 || items[i].first > capacity) continue;
+        int end = endQuery[i] == -1 ? queries : endQuery[i];
+        assignInterval(1, 0, queries, firstQuery[i], end, i, nodeItems);
+    }
+
+    vector<int> row(capacity + 1, 0);
+    replayNode(1, 0, queries, nodeItems, items, row, answers, capacity);
+    return answers;
+}
+
+long long InventorySystem::maximizeCarryValueBounded(int capacity, vector<vector<int>>& stacks) {
+    // For one stack (w, v, c), capacities with the same residue r = W mod w
+    // form a chain W = r + k*w, and
+    //   dp'[r + k*w] = max over t in [k - c, k] of (dp[r + t*w] - t*v) + k*v
+    // a sliding-window maximum kept in a monotone deque, so each stack
+    // costs O(W) however large its count is
+    if (capacity <= 0) {
+        return 0;
+    }
+
+    // a full bag can be worth more than INT_MAX (e.g. many high-value units)
+    vector<long long> dp(capacity + 1, 0);
+    vector<long long> prev(capacity + 1);
+    vector<int> window(capacity + 1); // monotone deque of chain positions t, reused per residue
+    long long freeValue = 0;
+
+    for (auto& stack : stacks) {
+        int weight = stack[0];
+        int value = stack[1];
+        int count = stack[2];
+        if (count <= 0 || value <= 0 || weight < 0 || weight > capacity) continue;
+        if (weight == 0) {
+            freeValue += (long long)value * count;
+            continue;
+        }
+        count = min(count, capacity / weight);
+
+        prev = dp;
+        for (int r = 0; r < weight; r++) {
+            int head = 0, tail = 0; // window[head..tail)
+            for (int k = 0; r + k * weight <= capacity; k++) {
+                // candidate t = k enters the window
+                long long key = prev[r + k * weight] - (long long)k * value;
+                while (tail > head &&
+                       prev[r + window[tail - 1] * weight] - (long long)window[tail - 1] * value <= key) {
+                    tail--;
+                }
+                window[tail++] = k;
+                // drop t < k - count
+                if (window[head] < k - count) {
+                    head++;
+                }
+                int t = window[head];
+                dp[r + k * weight] = prev[r + t * weight] + (long long)(k - t) * value;
+            }
+        }
+    }
+
+    return dp[capacity] + freeValue;
+}
+
+// --- Streaming string decoder ---
+static char asciiLower(char c) {
+    return (c >= 'A' && c <= 'Z') ? c - 'A' + 'a' : c;
+}
+
+StringDecoder::StringDecoder() {
+    reset();
+}
+
+void StringDecoder::reset() {
+    current = 1;  // empty input: one way, do nothing
+    previous = 1;
+    last = 0;
+    broken = false;
+}
+
+void StringDecoder::feed(string_view chunk) {
+    // Rules: "uu" can be decoded as "w" or "uu"
+    //        "nn" can be decoded as "m" or "nn"
+    // dp[i] = dp[i-1] (+ dp[i-2] when the last two characters are uu/nn);
+    // the pair check uses `last`, so a pair split across chunks still counts
+    const long long MOD = 1000000007;
+    if (broken) return;
+
+    for (char raw : chunk) {
+        char character = asciiLower(raw);
+        // invalid input (keyboard is broken, cannot produce 'w' or 'm')
+        if (character == 'w' || character == 'm') {
+            broken = true;
+            return;
+        }
+
+        long long next = current;
+        if (character == last && (character == 'u' || character == 'n')) {
+            next = current + previous; // both < MOD, one subtraction reduces it
+            if (next >= MOD) next -= MOD;
+        }
+        previous = current;
+        current = next;
+        last = character;
+    }
+}
+
+long long StringDecoder::result() const {
+    return broken ? 0 : current;
+}
+
+long long InventorySystem::countStringPossibilities(string s) {
+    // Single pass with O(1) state, no lowercase copy or dp array
+    StringDecoder decoder;
+    decoder.feed(s);
+    return decoder.result();
+}
+
+// The recurrence is linear in (current, previous): a character maps it by
+//   [[1, 1], [1, 0]] after a matching u/n, [[1, 0], [1, 0]] otherwise.
+// A chunk's product of those 2x2 matrices is found by running the
+// recurrence from the two unit states at once; `before` is the character
+// preceding the chunk so pairs across chunk borders are still seen.
+struct DecodeTransfer {
+    long long m[2][2]; // column 0: image of (1, 0), column 1: image of (0, 1)
+    bool broken;
+};
+
+static DecodeTransfer decodeChunkTransfer(const char* begin, const char* end, char before) {
+    const long long MOD = 1000000007;
+    long long cur0 = 1, prev0 = 0; // start (current, previous) = (1, 0)
+    long long cur1 = 0, prev1 = 1; // start (current, previous) = (0, 1)
+    char last = asciiLower(before);
+    for (const char* p = begin; p != end; p++) {
+        char character = asciiLower(*p);
+        if (character == 'w' || character == 'm') {
+            return {{{0, 0}, {0, 0}}, true};
+        }
+        long long next0 = cur0, next1 = cur1;
+        if (character == last && (character == 'u' || character == 'n')) {
+            next0 += prev0;
+            if (next0 >= MOD) next0 -= MOD;
+            next1 += prev1;
+            if (next1 >= MOD) next1 -= MOD;
+        }
+        prev0 = cur0;
+        cur0 = next0;
+        prev1 = cur1;
+        cur1 = next1;
+        last = character;
+    }
+    return {{{cur0, cur1}, {prev0, prev1}}, false};
+}
+
+long long InventorySystem::countStringPossibilitiesParallel(const string& s, int threads) {
+    const long long MOD = 1000000007;
+    const size_t minChunk = 1 << 16; // below this a thread costs more than it saves
+    size_t n = s.size();
+    int workers = (int)min<size_t>(resolveThreadCount(threads), max<size_t>(1, n / minChunk));
+
+    vector<DecodeTransfer> transfers(workers);
+    auto work = [&](int t) {
+        size_t lo = n * t / workers;
+        size_t hi = n * (t + 1) / workers;
+        char before = lo == 0 ? 0 : s[lo - 1];
+        transfers[t] = decodeChunkTransfer(s.data() + lo, s.data() + hi, before);
+    };
+
+    vector<thread> pool;
+    for (int t = 1; t < workers; t++) {
+        pool.emplace_back(work, t);
+    }
+    work(0);
+    for (auto& worker : pool) {
+        worker.join();
+    }
+
+    // Apply the chunk matrices in order to the empty-input state (1, 1)
+    long long current = 1, previous = 1;
+    for (auto& transfer : transfers) {
+        if (transfer.broken) return 0;
+        long long nextCurrent = (transfer.m[0][0] * current + transfer.m[0][1] * previous) % MOD;
+        long long nextPrevious = (transfer.m[1][0] * current + transfer.m[1][1] * previous) % MOD;
+        current = nextCurrent;
+        previous = nextPrevious;
+    }
+    return current;
+}
+
+// --- Batched string decoding ---
+// Counts only change at "pair" positions (a u or n equal to the character
+// before it). A run of k consecutive pair positions multiplies the count
+// by Fib(k + 2), and runs are independent, so a message's count is the
+// product over its runs. The pair and w/m positions of the whole buffer
+// are marked 32 bytes at a time, then each message just walks its runs.
+static void markDecodeBitsScalar(const string& buffer, size_t from, size_t to,
+                                 vector<uint64_t>& pairBits, vector<uint64_t>& badBits) {
+    for (size_t i = from; i < to; i++) {
+        char c = asciiLower(buffer[i]);
+        char before = i == 0 ? 0 : asciiLower(buffer[i - 1]);
+        if (c == before && (c == 'u' || c == 'n')) pairBits[i / 64] |= 1ULL << (i % 64);
+        if (c == 'w' || c == 'm') badBits[i / 64] |= 1ULL << (i % 64);
+    }
+}
+
+#ifdef ARCADIA_X86_SIMD
+__attribute__((target("avx2")))
+static void markDecodeBitsAVX2(const string& buffer, vector<uint64_t>& pairBits, vector<uint64_t>& badBits) {
+    const char* data = buffer.data();
+    size_t n = buffer.size();
+    // OR 0x20 lowercases letters; no other byte maps onto u, n, w or m
+    const __m256i lowerBit = _mm256_set1_epi8(0x20);
+    const __m256i u = _mm256_set1_epi8('u'), nn = _mm256_set1_epi8('n');
+    const __m256i w = _mm256_set1_epi8('w'), m = _mm256_set1_epi8('m');
+
+    size_t i = 1;
+    markDecodeBitsScalar(buffer, 0, min<size_t>(n, 1), pairBits, badBits);
+    for (; i + 32 <= n; i += 32) {
+        __m256i cur = _mm256_or_si256(_mm256_loadu_si256((const __m256i*)(data + i)), lowerBit);
+        __m256i before = _mm256_or_si256(_mm256_loadu_si256((const __m256i*)(data + i - 1)), lowerBit);
+        __m256i isU = _mm256_cmpeq_epi8(cur, u);
+        __m256i isN = _mm256_cmpeq_epi8(cur, nn);
+        __m256i same = _mm256_cmpeq_epi8(cur, before);
+        __m256i pair = _mm256_and_si256(same, _mm256_or_si256(isU, isN));
+        __m256i bad = _mm256_or_si256(_mm256_cmpeq_epi8(cur, w), _mm256_cmpeq_epi8(cur, m));
+
+        uint64_t pairMask = (uint32_t)_mm256_movemask_epi8(pair);
+        uint64_t badMask = (uint32_t)_mm256_movemask_epi8(bad);
+        // the 32 bits may straddle two words
+        pairBits[i / 64] |= pairMask << (i % 64);
+        badBits[i / 64] |= badMask << (i % 64);
+        if (i % 64 > 32) {
+            pairBits[i / 64 + 1] |= pairMask >> (64 - i % 64);
+            badBits[i / 64 + 1] |= badMask >> (64 - i % 64);
+        }
+    }
+    markDecodeBitsScalar(buffer, i, n, pairBits, badBits);
+}
+#endif
+
+// First set bit of bits in [from, to), or to if none
+static size_t nextSetBit(const vector<uint64_t>& bits, size_t from, size_t to) {
+    while (from < to) {
+        uint64_t word = bits[from / 64] >> (from % 64);
+        if (word != 0) {
+            return min(to, from + __builtin_ctzll(word));
+        }
+        from = (from / 64 + 1) * 64;
+    }
+    return to;
+}
+
+// First clear bit of bits in [from, to), or to if none
+static size_t nextClearBit(const vector<uint64_t>& bits, size_t from, size_t to) {
+    while (from < to) {
+        uint64_t word = ~bits[from / 64] >> (from % 64);
+        if (word != 0) {
+            return min(to, from + __builtin_ctzll(word));
+        }
+        from = (from / 64 + 1) * 64;
+    }
+    return to;
+}
+
+vector<long long> InventorySystem::countStringPossibilitiesBatch(const string& buffer, const vector<int>& offsets) {
+    const long long MOD = 1000000007;
+    size_t messages = offsets.empty() ? 0 : offsets.size() - 1;
+    vector<long long> counts(messages, 0);
+    if (messages == 0) return counts;
+
+    size_t n = buffer.size();
+    vector<uint64_t> pairBits(n / 64 + 2, 0), badBits(n / 64 + 2, 0);
+#ifdef ARCADIA_X86_SIMD
+    if (cpuHasAVX2()) {
+        markDecodeBitsAVX2(buffer, pairBits, badBits);
+    } else {
+        markDecodeBitsScalar(buffer, 0, n, pairBits, badBits);
+    }
+#else
+    markDecodeBitsScalar(buffer, 0, n, pairBits, badBits);
+#endif
+
+    // fib[k] = Fib(k) mod p, sized for the longest message
+    size_t longest = 0;
+    for (size_t i = 0; i < messages; i++) {
+        longest = max(longest, (size_t)max(0, offsets[i + 1] - offsets[i]));
+    }
+    vector<long long> fib(longest + 3, 1);
+    for (size_t k = 3; k < fib.size(); k++) {
+        fib[k] = (fib[k - 1] + fib[k - 2]) % MOD;
+    }
+
+    for (size_t i = 0; i < messages; i++) {
+        size_t begin = offsets[i], end = offsets[i + 1];
+        if (end <= begin) {
+            counts[i] = 1; // empty message
+            continue;
+        }
+        if (nextSetBit(badBits, begin, end) != end) {
+            continue; // contains w or m
+        }
+
+        long long count = 1;
+        // the first character never pairs with the previous message
+        size_t pos = nextSetBit(pairBits, begin + 1, end);
+        while (pos < end) {
+            size_t runEnd = nextClearBit(pairBits, pos, end);
+            count = count * fib[runEnd - pos + 2] % MOD;
+            pos = nextSetBit(pairBits, runEnd, end);
+        }
+        counts[i] = count;
+    }
+    return counts;
+}
+
+// =========================================================
+// PART C: WORLD NAVIGATOR (Graphs)
+// =========================================================
+// --- World graph (CSR) ---
+WorldGraph::WorldGraph(int n, const vector<vector<int>>& roads)
+    : n(max(0, n)), roads(roads.size()), offsetList(max(0, n) + 1, 0) {
+    // Counting sort by endpoint: count degrees, prefix sum, then scatter
+    for (auto& r : roads) {
+        offsetList[r[0] + 1]++;
+        offsetList[r[1] + 1]++;
+    }
+    for (int u = 0; u < this->n; u++) {
+        offsetList[u + 1] += offsetList[u];
+    }
+
+    bool hasColumn[2] = {false, false};
+    for (auto& r : roads) {
+        for (int c = 0; c < 2; c++) {
+            if ((int)r.size() > 2 + c) hasColumn[c] = true;
+        }
+    }
+    targetList.resize(offsetList[this->n]);
+    for (int c = 0; c < 2; c++) {
+        if (hasColumn[c]) weightLists[c].resize(targetList.size());
+    }
+
+    vector<int> next(offsetList.begin(), offsetList.end() - 1);
+    for (auto& r : roads) {
+        int u = r[0];
+        int v = r[1];
+        int slots[2] = {next[u]++, next[v]++};
+        targetList[slots[0]] = v;
+        targetList[slots[1]] = u;
+        for (int c = 0; c < 2; c++) {
+            if (!hasColumn[c]) continue;
+            int w = (int)r.size() > 2 + c ? r[2 + c] : 0; // missing columns read as 0
+            weightLists[c][slots[0]] = w;
+            weightLists[c][slots[1]] = w;
+        }
+    }
+}
+
+int WorldGraph::vertexCount() const {
+    return n;
+}
+
+int WorldGraph::roadCount() const {
+    return roads;
+}
+
+const vector<int>& WorldGraph::offsets() const {
+    return offsetList;
+}
+
+const vector<int>& WorldGraph::targets() const {
+    return targetList;
+}
+
+const vector<int>& WorldGraph::weights(int column) const {
+    return weightLists[column];
+}
+
+// --- Connectivity index ---
+ConnectivityIndex::ConnectivityIndex(int n, const vector<vector<int>>& edges)
+    : parent(max(0, n)), rank(max(0, n), 0), components(max(0, n)) {
+    for (int i = 0; i < (int)parent.size(); i++) {
+        parent[i] = i;
+    }
+    for (auto& e : edges) {
+        addRoad(e[0], e[1]);
+    }
+}
+
+ConnectivityIndex::ConnectivityIndex(const WorldGraph& graph)
+    : parent(graph.vertexCount()), rank(graph.vertexCount(), 0), components(graph.vertexCount()) {
+    const vector<int>& offsets = graph.offsets();
+    const vector<int>& targets = graph.targets();
+    for (int i = 0; i < (int)parent.size(); i++) {
+        parent[i] = i;
+    }
+    for (int u = 0; u < (int)parent.size(); u++) {
+        for (int e = offsets[u]; e < offsets[u + 1]; e++) {
+            if (targets[e] > u) addRoad(u, targets[e]); // each road is stored twice
+        }
+    }
+}
+
+int ConnectivityIndex::find(int x) {
+    int root = x;
+    while (parent[root] != root) {
+        root = parent[root];
+    }
+    // Path compression: point everything on the way straight at the root
+    while (parent[x] != root) {
+        int next = parent[x];
+        parent[x] = root;
+        x = next;
+    }
+    return root;
+}
+
+void ConnectivityIndex::addRoad(int u, int v) {
+    int ru = find(u);
+    int rv = find(v);
+    if (ru == rv) return;
+    // Union by rank: hang the shallower tree under the deeper one
+    if (rank[ru] < rank[rv]) swap(ru, rv);
+    parent[rv] = ru;
+    if (rank[ru] == rank[rv]) rank[ru]++;
+    components--;
+}
+
+bool ConnectivityIndex::connected(int u, int v) {
+    return u == v || find(u) == find(v);
+}
+
+vector<bool> ConnectivityIndex::connectedBatch(const vector<pair<int, int>>& queries) {
+    // For batches on the order of the map size, flatten every tree first so
+    // each query is just two loads
+    if (queries.size() * 4 >= parent.size()) {
+        for (int i = 0; i < (int)parent.size(); i++) {
+            find(i);
+        }
+        vector<bool> answers(queries.size());
+        for (size_t i = 0; i < queries.size(); i++) {
+            answers[i] = parent[queries[i].first] == parent[queries[i].second];
+        }
+        return answers;
+    }
+    vector<bool> answers(queries.size());
+    for (size_t i = 0; i < queries.size(); i++) {
+        answers[i] = connected(queries[i].first, queries[i].second);
+    }
+    return answers;
+}
+
+int ConnectivityIndex::representative(int u) {
+    return find(u);
+}
+
+int ConnectivityIndex::componentCount() const {
+    return components;
+}
+
+bool WorldNavigator::pathExists(int n, vector<vector<int>>& edges, int source, int dest) {
+    // Implement path existence check using BFS or DFS
+    if (source == dest)
+        return true;
+    return pathExists(WorldGraph(n, edges), source, dest);
+}
+
+// One side of the bidirectional search in pathExists
+struct SearchSide {
+    unsigned char label;      // mark of the vertices this side reached
+    vector<int> frontier;     // vertices reached in the last step
+    long long frontierEdges;  // sum of their degrees
+    bool growing;             // frontier has more edges than the one before
+    bool bottomUp;            // current direction of this side
+};
+
+// Direction-optimizing switch points (Beamer et al.): go bottom-up once a
+// growing frontier holds more than 1/14 of the unexplored edges, and back
+// top-down once it shrinks below 1/24 of the vertices
+static const long long kBottomUpAlpha = 14;
+static const long long kBottomUpBeta = 24;
+
+// Expands one level of side; returns true as soon as it touches the other side
+static bool expandSearchSide(const WorldGraph& graph, SearchSide& side, const SearchSide& other,
+                             vector<unsigned char>& label, vector<uint64_t>& frontierBits,
+                             long long& unexploredEdges) {
+    const vector<int>& offsets = graph.offsets();
+    const vector<int>& targets = graph.targets();
+    int n = graph.vertexCount();
+    vector<int> next;
+    long long nextEdges = 0;
+
+    if (side.growing && side.frontierEdges > unexploredEdges / kBottomUpAlpha) {
+        side.bottomUp = true;
+    } else if ((long long)side.frontier.size() < n / kBottomUpBeta) {
+        side.bottomUp = false;
+    }
+
+    if (!side.bottomUp) {
+        // Top-down: push every unlabelled neighbour of the frontier
+        for (int u : side.frontier) {
+            for (int e = offsets[u]; e < offsets[u + 1]; e++) {
+                int v = targets[e];
+                if (label[v] == side.label) continue;
+                if (label[v] != 0) return true; // met the other side
+                label[v] = side.label;
+                next.push_back(v);
+                nextEdges += offsets[v + 1] - offsets[v];
+            }
+        }
+    } else {
+        // Bottom-up: every unreached vertex looks for a parent in the
+        // frontier bitmap and stops at the first one
+        fill(frontierBits.begin(), frontierBits.end(), 0);
+        for (int u : side.frontier) {
+            frontierBits[u / 64] |= 1ULL << (u % 64);
+        }
+        // Vertices the other side already expanded have every neighbour
+        // labelled, so the two sides can only touch at its frontier
+        for (int v : other.frontier) {
+            for (int e = offsets[v]; e < offsets[v + 1]; e++) {
+                int u = targets[e];
+                if ((frontierBits[u / 64] >> (u % 64)) & 1) return true;
+            }
+        }
+        for (int v = 0; v < n; v++) {
+            if (label[v] != 0) continue;
+            for (int e = offsets[v]; e < offsets[v + 1]; e++) {
+                int u = targets[e];
+                if ((frontierBits[u / 64] >> (u % 64)) & 1) {
+                    label[v] = side.label;
+                    next.push_back(v);
+                    nextEdges += offsets[v + 1] - offsets[v];
+                    break;
+                }
+            }
+        }
+    }
+
+    unexploredEdges -= nextEdges;
+    side.frontier.swap(next);
+    side.growing = nextEdges > side.frontierEdges;
+    side.frontierEdges = nextEdges;
+    return false;
+}
+
+bool WorldNavigator::pathExists(const WorldGraph& graph, int source, int dest) {
+    if (source == dest)
+        return true;
+    const vector<int>& offsets = graph.offsets();
+    int n = graph.vertexCount();
+
+    // Bidirectional BFS: grow whichever side has the cheaper frontier, so
+    // a dead end is found after exploring only the smaller component
+    vector<unsigned char> label(n, 0);
+    vector<uint64_t> frontierBits((n + 63) / 64);
+    long long unexploredEdges = offsets[n];
+
+    SearchSide sides[2] = {{1, {source}, 0, true, false}, {2, {dest}, 0, true, false}};
+    for (SearchSide& side : sides) {
+        int start = side.frontier[0];
+        label[start] = side.label;
+        side.frontierEdges = offsets[start + 1] - offsets[start];
+        unexploredEdges -= side.frontierEdges;
+    }
+
+    while (!sides[0].frontier.empty() && !sides[1].frontier.empty())
+    {
+        int s = sides[0].frontierEdges <= sides[1].frontierEdges ? 0 : 1;
+        if (expandSearchSide(graph, sides[s], sides[1 - s], label, frontierBits, unexploredEdges))
+            return true;
+    }
+    // one side ran out without meeting the other: different components
+    return false;
+}
+
+// --- Parallel connected components (Afforest) ---
+// comp[x] <= x always holds, so every tree is rooted at its smallest vertex.
+// Hooks the larger of the two roots under the smaller with a CAS; a failed
+// CAS means another thread moved that root, so retry from the new parents
+static void linkComponents(vector<atomic<int>>& comp, int u, int v) {
+    int p1 = comp[u].load(memory_order_relaxed);
+    int p2 = comp[v].load(memory_order_relaxed);
+    while (p1 != p2) {
+        int high = max(p1, p2);
+        int low = min(p1, p2);
+        int expected = high;
+        if (comp[high].load(memory_order_relaxed) == high &&
+            comp[high].compare_exchange_strong(expected, low)) {
+            return;
+        }
+        p1 = comp[comp[high].load(memory_order_relaxed)].load(memory_order_relaxed);
+        p2 = comp[low].load(memory_order_relaxed);
+    }
+}
+
+static void compressComponents(vector<atomic<int>>& comp, int lo, int hi) {
+    for (int v = lo; v < hi; v++) {
+        while (comp[v].load(memory_order_relaxed) != comp[comp[v].load(memory_order_relaxed)].load(memory_order_relaxed)) {
+            comp[v].store(comp[comp[v].load(memory_order_relaxed)].load(memory_order_relaxed), memory_order_relaxed);
+        }
+    }
+}
+
+vector<int> WorldNavigator::labelComponents(const WorldGraph& graph, int threads) {
+    const int sampledNeighbors = 2;   // first neighbours linked before sampling
+    const int sampleSize = 1024;      // vertices sampled to guess the giant component
+    const int minVerticesPerThread = 1 << 14;
+    const vector<int>& offsets = graph.offsets();
+    const vector<int>& targets = graph.targets();
+    int n = graph.vertexCount();
+    if (n == 0) return {};
+
+    int workers = min(resolveThreadCount(threads), max(1, n / minVerticesPerThread));
+    vector<atomic<int>> comp(n);
+    ThreadBarrier barrier(workers);
+    int largest = -1;
+
+    // Afforest: link a couple of neighbours per vertex, which already
+    // merges most of a giant component, then skip that component while
+    // linking the remaining edges
+    auto work = [&](int t) {
+        int lo = (long long)n * t / workers;
+        int hi = (long long)n * (t + 1) / workers;
+        for (int v = lo; v < hi; v++) {
+            comp[v].store(v, memory_order_relaxed);
+        }
+        barrier.arriveAndWait();
+
+        for (int r = 0; r < sampledNeighbors; r++) {
+            for (int v = lo; v < hi; v++) {
+                if (offsets[v] + r < offsets[v + 1]) {
+                    linkComponents(comp, v, targets[offsets[v] + r]);
+                }
+            }
+            barrier.arriveAndWait();
+            compressComponents(comp, lo, hi);
+            barrier.arriveAndWait();
+        }
+
+        if (t == 0) {
+            // most frequent root among a fixed pseudo-random sample
+            unordered_map<int, int> frequency;
+            unsigned long long seed = 88172645463325252ULL;
+            int bestCount = 0;
+            for (int i = 0; i < sampleSize; i++) {
+                seed ^= seed << 13;
+                seed ^= seed >> 7;
+                seed ^= seed << 17;
+                int root = comp[seed % n].load(memory_order_relaxed);
+                if (++frequency[root] > bestCount) {
+                    bestCount = frequency[root];
+                    largest = root;
+                }
+            }
+        }
+        barrier.arriveAndWait();
+
+        for (int v = lo; v < hi; v++) {
+            if (comp[v].load(memory_order_relaxed) == largest) continue;
+            for (int e = offsets[v] + sampledNeighbors; e < offsets[v + 1]; e++) {
+                linkComponents(comp, v, targets[e]);
+            }
+        }
+        barrier.arriveAndWait();
+        compressComponents(comp, lo, hi);
+    };
+
+    vector<thread> pool;
+    for (int t = 1; t < workers; t++) {
+        pool.emplace_back(work, t);
+    }
+    work(0);
+    for (auto& worker : pool) {
+        worker.join();
+    }
+
+    // Number components densely in order of their smallest vertex (the root)
+    vector<int> ids(n);
+    int components = 0;
+    for (int v = 0; v < n; v++) {
+        int root = comp[v].load(memory_order_relaxed);
+        ids[v] = root == v ? components++ : ids[root];
+    }
+    return ids;
+}
+
+long long WorldNavigator::minBribeCost(int n, int m, long long goldRate, long long silverRate, vector<vector<int>>& roadData) {
+    // Implement Minimum Spanning Tree (Kruskal's or Prim's)
+    // roadData[i] = {u, v, goldCost, silverCost}
+    return minBribeCost(WorldGraph(n, roadData), goldRate, silverRate);
+    // Total cost = goldCost * goldRate + silverCost * silverRate
+    // Return -1 if graph cannot be fully connected
+}
+
+// --- Spanning tree solvers for minBribeCost ---
+// Each returns the tree cost, or -1 if the map is not connected
+
+struct MSTEdge {
+    long long cost;
+    int u;
+    int v;
+
+    bool operator<(const MSTEdge& other) const {
+        return cost < other.cost;
+    }
+};
+
+// Sorts chunks on separate threads, then merges neighbouring runs pairwise,
+// each level's merges again in parallel
+template <typename T>
+static void parallelSort(typename vector<T>::iterator first, typename vector<T>::iterator last, int threads) {
+    const long long minChunk = 1 << 15; // below this a thread costs more than it saves
+    long long n = last - first;
+    int chunks = (int)min<long long>(resolveThreadCount(threads), max(1LL, n / minChunk));
+    if (chunks <= 1) {
+        sort(first, last);
+        return;
+    }
+
+    vector<long long> bounds(chunks + 1);
+    for (int c = 0; c <= chunks; c++) {
+        bounds[c] = n * c / chunks;
+    }
+    vector<thread> pool;
+    for (int c = 0; c < chunks; c++) {
+        pool.emplace_back([&, c] { sort(first + bounds[c], first + bounds[c + 1]); });
+    }
+    for (auto& worker : pool) {
+        worker.join();
+    }
+
+    for (int width = 1; width < chunks; width *= 2) {
+        pool.clear();
+        for (int c = 0; c + width < chunks; c += 2 * width) {
+            long long lo = bounds[c];
+            long long mid = bounds[c + width];
+            long long hi = bounds[min(c + 2 * width, chunks)];
+            pool.emplace_back([=] { inplace_merge(first + lo, first + mid, first + hi); });
+        }
+        for (auto& worker : pool) {
+            worker.join();
+        }
+    }
+}
+
+// Every road once (u < v, self-loops dropped) with its bribe precomputed;
+// vertex ranges are split across threads, counted first so each range
+// knows where its edges go
+static vector<MSTEdge> collectMSTEdges(const WorldGraph& graph, long long goldRate, long long silverRate,
+                                       int threads) {
+    const int minVerticesPerThread = 1 << 14;
+    const vector<int>& offsets = graph.offsets();
+    const vector<int>& targets = graph.targets();
+    const vector<int>& gold = graph.weights(0);
+    const vector<int>& silver = graph.weights(1);
+    int n = graph.vertexCount();
+    int workers = min(resolveThreadCount(threads), max(1, n / minVerticesPerThread));
+
+    vector<long long> starts(workers + 1, 0);
+    vector<MSTEdge> edges;
+    ThreadBarrier barrier(workers);
+    auto work = [&](int t) {
+        int lo = (long long)n * t / workers;
+        int hi = (long long)n * (t + 1) / workers;
+        long long count = 0;
+        for (int u = lo; u < hi; u++) {
+            for (int e = offsets[u]; e < offsets[u + 1]; e++) {
+                if (targets[e] > u) count++;
+            }
+        }
+        starts[t + 1] = count;
+        barrier.arriveAndWait();
+        if (t == 0) {
+            partial_sum(starts.begin(), starts.end(), starts.begin());
+            edges.resize(starts[workers]);
+        }
+        barrier.arriveAndWait();
+
+        long long next = starts[t];
+        for (int u = lo; u < hi; u++) {
+            for (int e = offsets[u]; e < offsets[u + 1]; e++) {
+                if (targets[e] <= u) continue;
+                long long goldCost = gold.empty() ? 0 : gold[e];
+                long long silverCost = silver.empty() ? 0 : silver[e];
+                edges[next++] = {goldCost * goldRate + silverCost * silverRate, u, targets[e]};
+            }
+        }
+    };
+
+    vector<thread> pool;
+    for (int t = 1; t < workers; t++) {
+        pool.emplace_back(work, t);
+    }
+    work(0);
+    for (auto& worker : pool) {
+        worker.join();
+    }
+    return edges;
+}
+
+// Filter-Kruskal: edges below a pivot are solved first; the heavy part is
+// then filtered against the forest so far before it is ever sorted.
+// Ranges up to baseSize are sorted outright. Edge needs cost, u, v and
+// operator<; addTreeEdge is called for every edge taken into the tree
+template <typename Edge, typename AddTreeEdge>
+static void filterKruskal(vector<Edge>& edges, size_t lo, size_t hi, size_t baseSize,
+                          ConnectivityIndex& forest, AddTreeEdge& addTreeEdge, int threads) {
+    if (forest.componentCount() <= 1 || lo >= hi) return;
+
+    auto takeInOrder = [&](size_t from, size_t to) {
+        for (size_t i = from; i < to && forest.componentCount() > 1; i++) {
+            if (!forest.connected(edges[i].u, edges[i].v)) {
+                forest.addRoad(edges[i].u, edges[i].v);
+                addTreeEdge(edges[i]);
+            }
+        }
+    };
+    if (hi - lo <= baseSize) {
+        parallelSort<Edge>(edges.begin() + lo, edges.begin() + hi, threads);
+        takeInOrder(lo, hi);
+        return;
+    }
+
+    // median of three as the pivot; ties go to the light side so a range of
+    // equal costs still shrinks
+    long long a = edges[lo].cost, b = edges[lo + (hi - lo) / 2].cost, c = edges[hi - 1].cost;
+    long long pivot = max(min(a, b), min(max(a, b), c));
+    size_t split = partition(edges.begin() + lo, edges.begin() + hi,
+                             [pivot](const Edge& e) { return e.cost <= pivot; }) - edges.begin();
+    if (split == hi) {
+        // nothing heavier than the pivot: split off the edges equal to it
+        split = partition(edges.begin() + lo, edges.begin() + hi,
+                          [pivot](const Edge& e) { return e.cost < pivot; }) - edges.begin();
+        if (split == lo) {
+            // all costs equal, any order is sorted
+            takeInOrder(lo, hi);
+            return;
+        }
+    }
+
+    filterKruskal(edges, lo, split, baseSize, forest, addTreeEdge, threads);
+    size_t kept = remove_if(edges.begin() + split, edges.begin() + hi,
+                            [&forest](const Edge& e) { return forest.connected(e.u, e.v); }) - edges.begin();
+    filterKruskal(edges, split, kept, baseSize, forest, addTreeEdge, threads);
+}
+
+static long long minBribeCostKruskal(const WorldGraph& graph, long long goldRate, long long silverRate, int threads) {
+    int n = graph.vertexCount();
+    vector<MSTEdge> edges = collectMSTEdges(graph, goldRate, silverRate, threads);
+    ConnectivityIndex forest(n, {});
+    long long total = 0;
+    auto addCost = [&total](const MSTEdge& e) { total += e.cost; };
+    filterKruskal(edges, 0, edges.size(), max<size_t>(1024, n), forest, addCost, threads);
+    return forest.componentCount() <= 1 ? total : -1;
+}
+
+// Edge i is lighter than edge j: by cost, then by index so ties never form cycles
+static bool lighterEdge(const vector<MSTEdge>& edges, int i, int j) {
+    return j < 0 || edges[i].cost < edges[j].cost || (edges[i].cost == edges[j].cost && i < j);
+}
+
+static long long minBribeCostBoruvka(const WorldGraph& graph, long long goldRate, long long silverRate, int threads) {
+    const long long minEdgesPerThread = 1 << 15;
+    int n = graph.vertexCount();
+    vector<MSTEdge> edges = collectMSTEdges(graph, goldRate, silverRate, threads);
+    long long m = edges.size();
+    int workers = (int)min<long long>(resolveThreadCount(threads), max(1LL, m / minEdgesPerThread));
+
+    vector<int> comp(n);             // component of each vertex, as its forest representative
+    vector<atomic<int>> cheapest(n); // lightest edge leaving each component, -1 if none
+    iota(comp.begin(), comp.end(), 0);
+    ConnectivityIndex forest(n, {});
+    long long total = 0;
+
+    while (forest.componentCount() > 1) {
+        for (int c = 0; c < n; c++) {
+            cheapest[c].store(-1, memory_order_relaxed);
+        }
+
+        // Each thread scans a slice of the edges and lowers the cheapest
+        // edge of both endpoint components with a CAS
+        auto scan = [&](int t) {
+            long long lo = m * t / workers;
+            long long hi = m * (t + 1) / workers;
+            for (long long i = lo; i < hi; i++) {
+                int cu = comp[edges[i].u];
+                int cv = comp[edges[i].v];
+                if (cu == cv) continue;
+                for (int c : {cu, cv}) {
+                    int current = cheapest[c].load(memory_order_relaxed);
+                    while (lighterEdge(edges, (int)i, current) &&
+                           !cheapest[c].compare_exchange_weak(current, (int)i)) {
+                    }
+                }
+            }
+        };
+        vector<thread> pool;
+        for (int t = 1; t < workers; t++) {
+            pool.emplace_back(scan, t);
+        }
+        scan(0);
+        for (auto& worker : pool) {
+            worker.join();
+        }
+
+        bool merged = false;
+        for (int c = 0; c < n; c++) {
+            int i = cheapest[c].load(memory_order_relaxed);
+            if (i < 0 || forest.connected(edges[i].u, edges[i].v)) continue;
+            forest.addRoad(edges[i].u, edges[i].v);
+            total += edges[i].cost;
+            merged = true;
+        }
+        if (!merged) return -1; // some component has no road out
+
+        for (int v = 0; v < n; v++) {
+            comp[v] = forest.representative(v);
+        }
+    }
+    return total;
+}
+
+// Auto uses Prim once the map has more roads than this per vertex
+static const long long kPrimMinAverageDegree = 64;
+
+long long WorldNavigator::minBribeCost(const WorldGraph& graph, long long goldRate, long long silverRate,
+                                       MSTStrategy strategy, int threads) {
+    int n = graph.vertexCount();
+    const vector<int>& offsets = graph.offsets();
+    const vector<int>& targets = graph.targets();
+    const vector<int>& gold = graph.weights(0);
+    const vector<int>& silver = graph.weights(1);
+    if (n == 0)
+        return 0;
+
+    if (strategy == MSTStrategy::Auto) {
+        strategy = graph.roadCount() > (long long)n * kPrimMinAverageDegree ? MSTStrategy::Prim
+                                                                            : MSTStrategy::FilterKruskal;
+    }
+    if (strategy == MSTStrategy::FilterKruskal)
+        return minBribeCostKruskal(graph, goldRate, silverRate, threads);
+    if (strategy == MSTStrategy::Boruvka)
+        return minBribeCostBoruvka(graph, goldRate, silverRate, threads);
+
+    // Min-heap: (cost, vertex)
+    using P = pair<long long, int>; // cost, vertex
+    priority_queue<P, vector<P>, greater<P>> pq;
+
+    vector inMST(n, false);
+    vector minCost(n, LLONG_MAX);
+    vector<long long> minGold(n, 0);
+    vector<long long> minSilver(n, 0);
+
+    minCost[0] = 0;
+    pq.push({0, 0});
+
+    long long totalGold = 0, totalSilver = 0;
+    int count = 0;
+
+    while (!pq.empty()) {
+        auto [cost, u] = pq.top();
+        pq.pop();
+        if (inMST[u])
+            continue;
+
+        inMST[u] = true;
+        totalGold += minGold[u];
+        totalSilver += minSilver[u];
+        count++;
+
+        for (int e = offsets[u]; e < offsets[u + 1]; e++) {
+            int v = targets[e];
+            long long goldCost = gold.empty() ? 0 : gold[e];
+            long long silverCost = silver.empty() ? 0 : silver[e];
+            long long edgeCost = goldCost * goldRate + silverCost * silverRate;
+
+            if (!inMST[v] && edgeCost < minCost[v]) {
+                minCost[v] = edgeCost;
+                minGold[v] = goldCost;
+                minSilver[v] = silverCost;
+                pq.push({edgeCost, v});
+            }
+        }
+    }
+
+    if (count != n)
+        return -1;
+    return totalGold * goldRate + totalSilver * silverRate;
+}
+
+// --- Prepared bribe map (parametric MST) ---
+// Ratio p comes before q when p puts less weight on gold
+static bool goldShareLess(long long pGold, long long pSilver, long long qGold, long long qSilver) {
+    return (__int128)pGold * qSilver < (__int128)qGold * pSilver;
+}
+
+PreparedBribeMap::PreparedBribeMap(const WorldGraph& graph) : n(graph.vertexCount()), hits(0), probes(0) {
+    const vector<int>& offsets = graph.offsets();
+    const vector<int>& targets = graph.targets();
+    const vector<int>& gold = graph.weights(0);
+    const vector<int>& silver = graph.weights(1);
+    for (int u = 0; u < n; u++) {
+        for (int e = offsets[u]; e < offsets[u + 1]; e++) {
+            if (targets[e] <= u) continue;
+            roads.push_back({u, targets[e], gold.empty() ? 0 : gold[e], silver.empty() ? 0 : silver[e]});
+        }
+    }
+    // connectivity does not depend on the rates
+    connected = ConnectivityIndex(graph).componentCount() <= 1;
+}
+
+// Road of a PreparedBribeMap priced at one ratio, for filterKruskal
+struct PricedRoad {
+    long long cost;
+    int u;
+    int v;
+    int road; // index into the map's roads
+
+    bool operator<(const PricedRoad& other) const {
+        return cost < other.cost;
+    }
+};
+
+// MST at one ratio as (total gold, total silver). Filter-Kruskal when the
+// road costs fit in long long, a plain 128-bit sort otherwise
+pair<long long, long long> PreparedBribeMap::spanningTree(Ratio rates) const {
+    __int128 largest = 0;
+    for (const Road& road : roads) {
+        __int128 cost = (__int128)abs(road.gold) * rates.gold + (__int128)abs(road.silver) * rates.silver;
+        largest = max(largest, cost);
+    }
+
+    ConnectivityIndex forest(n, {});
+    long long totalGold = 0, totalSilver = 0;
+    if (largest <= LLONG_MAX) {
+        vector<PricedRoad> priced(roads.size());
+        for (size_t i = 0; i < roads.size(); i++) {
+            priced[i] = {roads[i].gold * rates.gold + roads[i].silver * rates.silver, roads[i].u, roads[i].v, (int)i};
+        }
+        auto addRoad = [&](const PricedRoad& e) {
+            totalGold += roads[e.road].gold;
+            totalSilver += roads[e.road].silver;
+        };
+        filterKruskal(priced, 0, priced.size(), max<size_t>(1024, n), forest, addRoad, 1);
+        return {totalGold, totalSilver};
+    }
+
+    vector<pair<__int128, int>> order(roads.size());
+    for (size_t i = 0; i < roads.size(); i++) {
+        order[i] = {(__int128)roads[i].gold * rates.gold + (__int128)roads[i].silver * rates.silver, (int)i};
+    }
+    sort(order.begin(), order.end());
+    for (size_t i = 0; i < order.size() && forest.componentCount() > 1; i++) {
+        const Road& road = roads[order[i].second];
+        if (forest.connected(road.u, road.v)) continue;
+        forest.addRoad(road.u, road.v);
+        totalGold += road.gold;
+        totalSilver += road.silver;
+    }
+    return {totalGold, totalSilver};
+}
+
+// The MST cost is a concave piecewise-linear function of the ratio and
+// every tree's cost is a line above it. A line that touches it at two
+// ratios therefore touches it on the whole range between them, which is
+// what lets a piece grow, and two neighbouring pieces meet where their
+// lines cross if the MST there costs exactly that (one Eisner-Severance
+// step). Tries that on the gap after pieces[i]; returns true if closed
+bool PreparedBribeMap::closeGap(size_t i) {
+    Piece& left = pieces[i];
+    Piece& right = pieces[i + 1];
+    // (G_left - G_right) * gold = (S_right - S_left) * silver
+    long long crossGold = right.silver - left.silver;
+    long long crossSilver = left.gold - right.gold;
+    if (crossGold < 0 || crossSilver < 0) {
+        crossGold = -crossGold;
+        crossSilver = -crossSilver;
+    }
+    if (crossGold == 0 && crossSilver == 0) return false;
+    long long divisor = gcd(crossGold, crossSilver);
+    Ratio cross = {crossGold / divisor, crossSilver / divisor};
+    if (!goldShareLess(left.hi.gold, left.hi.silver, cross.gold, cross.silver) ||
+        !goldShareLess(cross.gold, cross.silver, right.lo.gold, right.lo.silver)) {
+        return false;
+    }
+
+    probes++;
+    pair<long long, long long> tree = spanningTree(cross);
+    __int128 best = (__int128)tree.first * cross.gold + (__int128)tree.second * cross.silver;
+    __int128 ours = (__int128)left.gold * cross.gold + (__int128)left.silver * cross.silver;
+    if (best == ours) {
+        left.hi = cross;
+        right.lo = cross;
+        return true;
+    }
+    // another tree is cheaper at the crossing: keep it as a known point
+    pieces.insert(pieces.begin() + i + 1, {cross, cross, tree.first, tree.second});
+    return false;
+}
+
+long long PreparedBribeMap::cost(long long goldRate, long long silverRate) {
+    if (!connected)
+        return -1;
+    if (goldRate < 0 || silverRate < 0)
+        throw "Rates must be non-negative";
+    if (n <= 1 || (goldRate == 0 && silverRate == 0))
+        return 0;
+
+    if (pieces.empty()) {
+        // Pin both ends of the ratio range (all silver, all gold) first, so
+        // every later query falls into a range or a gap that can be closed
+        for (Ratio end : {Ratio{0, 1}, Ratio{1, 0}}) {
+            pair<long long, long long> tree = spanningTree(end);
+            pieces.push_back({end, end, tree.first, tree.second});
+        }
+        if (pieces[0].gold == pieces[1].gold && pieces[0].silver == pieces[1].silver) {
+            // one tree is optimal at both ends, hence everywhere
+            pieces[0].hi = pieces[1].hi;
+            pieces.pop_back();
+        }
+    }
+
+    // first piece starting after this ratio; the one before may contain it
+    size_t i = upper_bound(pieces.begin(), pieces.end(), Ratio{goldRate, silverRate},
+                           [](const Ratio& r, const Piece& p) {
+                               return goldShareLess(r.gold, r.silver, p.lo.gold, p.lo.silver);
+                           }) - pieces.begin();
+    bool hit = i > 0 && !goldShareLess(pieces[i - 1].hi.gold, pieces[i - 1].hi.silver, goldRate, silverRate);
+    if (hit) {
+        i--;
+        // repeats of a ratio seen before would hit without any probing
+        Piece& piece = pieces[i];
+        if (goldShareLess(piece.lo.gold, piece.lo.silver, piece.hi.gold, piece.hi.silver)) hits++;
+    } else {
+        Ratio rates = {goldRate, silverRate};
+        pair<long long, long long> tree = spanningTree(rates);
+        if (i > 0 && pieces[i - 1].gold == tree.first && pieces[i - 1].silver == tree.second) {
+            pieces[--i].hi = rates;
+        } else if (i < pieces.size() && pieces[i].gold == tree.first && pieces[i].silver == tree.second) {
+            pieces[i].lo = rates;
+        } else {
+            pieces.insert(pieces.begin() + i, {rates, rates, tree.first, tree.second});
+        }
+
+        // Probing the gaps on either side costs one more MST each; it only
+        // pays off if queries keep landing inside merged ranges, so allow
+        // a probe per such hit (after a few free ones)
+        if (probes < 16 + hits) {
+            if (i + 1 < pieces.size()) {
+                closeGap(i);
+            }
+            if (i > 0) {
+                size_t before = pieces.size();
+                closeGap(i - 1);
+                i += pieces.size() - before; // a point may have gone in before ours
+            }
+        }
+    }
+
+    __int128 total = (__int128)pieces[i].gold * goldRate + (__int128)pieces[i].silver * silverRate;
+    if (total > LLONG_MAX)
+        throw "Bribe cost overflow";
+    return (long long)total;
+}
+
+int PreparedBribeMap::cachedTrees() const {
+    return pieces.size();
+}
+
+// --- Dynamic bribe map (link-cut tree) ---
+DynamicBribeMap::DynamicBribeMap(int n, long long goldRate, long long silverRate)
+    : n(max(0, n)), goldRate(goldRate), silverRate(silverRate), nodes(max(0, n), {{-1, -1}, -1, false, 0}),
+      treeRoadsAt(max(0, n)), spareRoadsAt(max(0, n)), sideMark(max(0, n), 0), sideStamp(0),
+      treeRoads(0), total(0) {
+    for (int x = 0; x < this->n; x++) {
+        nodes[x].heaviest = x;
+    }
+}
+
+// Vertices never win a path-max query
+long long DynamicBribeMap::nodeCost(int x) const {
+    return x < n ? LLONG_MIN : roads[x - n].cost;
+}
+
+bool DynamicBribeMap::isSplayRoot(int x) const {
+    int p = nodes[x].parent;
+    return p == -1 || (nodes[p].child[0] != x && nodes[p].child[1] != x);
+}
+
+// Hand a pending reversal down to the children
+void DynamicBribeMap::push(int x) {
+    if (!nodes[x].flipped) return;
+    swap(nodes[x].child[0], nodes[x].child[1]);
+    for (int c : nodes[x].child) {
+        if (c != -1) nodes[c].flipped = !nodes[c].flipped;
+    }
+    nodes[x].flipped = false;
+}
+
+void DynamicBribeMap::pull(int x) {
+    nodes[x].heaviest = x;
+    for (int c : nodes[x].child) {
+        if (c != -1 && nodeCost(nodes[c].heaviest) > nodeCost(nodes[x].heaviest)) {
+            nodes[x].heaviest = nodes[c].heaviest;
+        }
+    }
+}
+
+void DynamicBribeMap::rotate(int x) {
+    int p = nodes[x].parent;
+    int g = nodes[p].parent;
+    int side = nodes[p].child[1] == x;
+    if (!isSplayRoot(p)) {
+        nodes[g].child[nodes[g].child[1] == p] = x;
+    }
+    nodes[x].parent = g;
+    nodes[p].child[side] = nodes[x].child[!side];
+    if (nodes[x].child[!side] != -1) {
+        nodes[nodes[x].child[!side]].parent = p;
+    }
+    nodes[x].child[!side] = p;
+    nodes[p].parent = x;
+    pull(p);
+    pull(x);
+}
+
+void DynamicBribeMap::splay(int x) {
+    // push reversals down from the splay root first
+    splayPath.assign(1, x);
+    for (int y = x; !isSplayRoot(y); y = nodes[y].parent) {
+        splayPath.push_back(nodes[y].parent);
+    }
+    for (int i = splayPath.size() - 1; i >= 0; i--) {
+        push(splayPath[i]);
+    }
+
+    while (!isSplayRoot(x)) {
+        int p = nodes[x].parent;
+        if (!isSplayRoot(p)) {
+            int g = nodes[p].parent;
+            bool zigZig = (nodes[g].child[1] == p) == (nodes[p].child[1] == x);
+            rotate(zigZig ? p : x);
+        }
+        rotate(x);
+    }
+}
+
+// Make the path from the tree root to x preferred, with x at the splay root
+void DynamicBribeMap::access(int x) {
+    int last = -1;
+    for (int y = x; y != -1; y = nodes[y].parent) {
+        splay(y);
+        nodes[y].child[1] = last;
+        pull(y);
+        last = y;
+    }
+    splay(x);
+}
+
+void DynamicBribeMap::makeRoot(int x) {
+    access(x);
+    nodes[x].flipped = !nodes[x].flipped;
+}
+
+int DynamicBribeMap::findRoot(int x) {
+    access(x);
+    push(x);
+    while (nodes[x].child[0] != -1) {
+        x = nodes[x].child[0];
+        push(x);
+    }
+    splay(x);
+    return x;
+}
+
+bool DynamicBribeMap::linked(int u, int v) {
+    return findRoot(u) == findRoot(v);
+}
+
+void DynamicBribeMap::link(int x, int y) {
+    makeRoot(x);
+    nodes[x].parent = y;
+}
+
+void DynamicBribeMap::cut(int x, int y) {
+    makeRoot(x);
+    access(y);
+    // x is now y's left child with nothing in between
+    nodes[y].child[0] = -1;
+    nodes[x].parent = -1;
+    pull(y);
+}
+
+void DynamicBribeMap::addToTree(int handle) {
+    Road& road = roads[handle];
+    link(road.u, n + handle);
+    link(n + handle, road.v);
+    treeRoadsAt[road.u].insert(handle);
+    treeRoadsAt[road.v].insert(handle);
+    road.state = TREE;
+    treeRoads++;
+    total += road.cost;
+}
+
+void DynamicBribeMap::removeFromTree(int handle) {
+    Road& road = roads[handle];
+    cut(road.u, n + handle);
+    cut(n + handle, road.v);
+    treeRoadsAt[road.u].erase(handle);
+    treeRoadsAt[road.v].erase(handle);
+    treeRoads--;
+    total -= road.cost;
+}
+
+void DynamicBribeMap::addSpare(int handle) {
+    roads[handle].state = SPARE;
+    spareRoadsAt[roads[handle].u].insert(handle);
+    spareRoadsAt[roads[handle].v].insert(handle);
+}
+
+void DynamicBribeMap::removeSpare(int handle) {
+    spareRoadsAt[roads[handle].u].erase(handle);
+    spareRoadsAt[roads[handle].v].erase(handle);
+}
+
+int DynamicBribeMap::otherEnd(int handle, int x) const {
+    return roads[handle].u == x ? roads[handle].v : roads[handle].u;
+}
+
+int DynamicBribeMap::openRoad(int u, int v, int goldCost, int silverCost) {
+    int handle = roads.size();
+    roads.push_back({u, v, goldCost * goldRate + silverCost * silverRate, SPARE});
+    nodes.push_back({{-1, -1}, -1, false, n + handle});
+
+    if (u == v) {
+        addSpare(handle);
+    } else if (!linked(u, v)) {
+        addToTree(handle);
+    } else {
+        // The road closes a cycle: it replaces the most expensive road on
+        // the tree path between its ends if it is cheaper
+        makeRoot(u);
+        access(v);
+        int heaviest = nodes[v].heaviest - n;
+        if (roads[heaviest].cost > roads[handle].cost) {
+            removeFromTree(heaviest);
+            addSpare(heaviest);
+            addToTree(handle);
+        } else {
+            addSpare(handle);
+        }
+    }
+    return handle;
+}
+
+void DynamicBribeMap::closeRoad(int handle) {
+    if (handle < 0 || handle >= (int)roads.size()) return;
+    Road& road = roads[handle];
+    if (road.state == SPARE) {
+        removeSpare(handle);
+    } else if (road.state == TREE) {
+        removeFromTree(handle);
+
+        // Walk both halves one vertex at a time; the first walk to run out
+        // has covered the smaller half
+        int stamps[2] = {++sideStamp, ++sideStamp};
+        vector<int> halves[2] = {{road.u}, {road.v}};
+        size_t heads[2] = {0, 0};
+        sideMark[road.u] = stamps[0];
+        sideMark[road.v] = stamps[1];
+        int small = -1;
+        for (int side = 0; small == -1; side = 1 - side) {
+            if (heads[side] == halves[side].size()) {
+                small = side;
+                break;
+            }
+            int x = halves[side][heads[side]++];
+            for (int h : treeRoadsAt[x]) {
+                int y = otherEnd(h, x);
+                if (sideMark[y] != stamps[side]) {
+                    sideMark[y] = stamps[side];
+                    halves[side].push_back(y);
+                }
+            }
+        }
+
+        // The cheapest spare road leaving the smaller half restores the tree
+        int replacement = -1;
+        for (int x : halves[small]) {
+            for (int h : spareRoadsAt[x]) {
+                if (sideMark[otherEnd(h, x)] == stamps[small]) continue;
+                if (replacement == -1 || roads[h].cost < roads[replacement].cost) {
+                    replacement = h;
+                }
+            }
+        }
+        if (replacement != -1) {
+            removeSpare(replacement);
+            addToTree(replacement);
+        }
+    }
+    road.state = CLOSED;
+}
+
+long long DynamicBribeMap::cost() const {
+    if (n <= 1)
+        return 0;
+    return treeRoads == n - 1 ? total : -1;
+}
+
+// Binary digits of a (non-negative) total
+string decimalToBinary(unsigned __int128 num){
+    if (num == 0)
+        return "0";
+    string bits = "";
+    while (num > 0){
+        bits += (num & 1) ? '1' : '0';
+        num >>= 1;
+    }
+    reverse(bits.begin(), bits.end());
+    return bits;
+}
+
+// --- Blocked Floyd-Warshall ---
+// The matrix is cut into kFloydTile x kFloydTile tiles; one relaxation
+// touches three tiles (3 x 32KB) which stay resident in L2
+static const int kFloydTile = 64;
+
+// Unreachable entries hold half the type's maximum: INF + INF still fits,
+// so min(d[i][j], d[i][k] + d[k][j]) saturates at INF with no branch
+static const long long kFloydInf64 = LLONG_MAX / 2;
+static const int kFloydInf32 = INT_MAX / 2;
+
+// Relax rows [rowBegin, rowEnd) x columns [colBegin, colEnd) of dist
+// through every vertex in [pivotBegin, pivotEnd)
+template <typename T>
+using MinPlusTileKernel = void (*)(T* dist, int n, int rowBegin, int rowEnd, int colBegin, int colEnd,
+                                   int pivotBegin, int pivotEnd);
+
+template <typename T>
+static void minPlusTileScalar(T* dist, int n, int rowBegin, int rowEnd, int colBegin, int colEnd,
+                              int pivotBegin, int pivotEnd) {
+    for (int k = pivotBegin; k < pivotEnd; k++) {
+        const T* through = dist + (size_t)k * n;
+        for (int i = rowBegin; i < rowEnd; i++) {
+            T* row = dist + (size_t)i * n;
+            T toPivot = row[k];
+            for (int j = colBegin; j < colEnd; j++) {
+                row[j] = min(row[j], (T)(toPivot + through[j]));
+            }
+        }
+    }
+}
+
+#ifdef ARCADIA_X86_SIMD
+// AVX2 has no 64-bit min; compare and blend instead
+__attribute__((target("avx2")))
+static void minPlusTileAVX2(long long* dist, int n, int rowBegin, int rowEnd, int colBegin, int colEnd,
+                            int pivotBegin, int pivotEnd) {
+    for (int k = pivotBegin; k < pivotEnd; k++) {
+        const long long* through = dist + (size_t)k * n;
+        for (int i = rowBegin; i < rowEnd; i++) {
+            long long* row = dist + (size_t)i * n;
+            __m256i toPivot = _mm256_set1_epi64x(row[k]);
+            int j = colBegin;
+            for (; j + 4 <= colEnd; j += 4) {
+                __m256i current = _mm256_loadu_si256((const __m256i*)(row + j));
+                __m256i candidate = _mm256_add_epi64(toPivot, _mm256_loadu_si256((const __m256i*)(through + j)));
+                __m256i shorter = _mm256_cmpgt_epi64(current, candidate);
+                _mm256_storeu_si256((__m256i*)(row + j), _mm256_blendv_epi8(current, candidate, shorter));
+            }
+            minPlusTileScalar(dist, n, i, i + 1, j, colEnd, k, k + 1);
+        }
+    }
+}
+
+__attribute__((target("avx2")))
+static void minPlusTileAVX2(int* dist, int n, int rowBegin, int rowEnd, int colBegin, int colEnd,
+                            int pivotBegin, int pivotEnd) {
+    for (int k = pivotBegin; k < pivotEnd; k++) {
+        const int* through = dist + (size_t)k * n;
+        for (int i = rowBegin; i < rowEnd; i++) {
+            int* row = dist + (size_t)i * n;
+            __m256i toPivot = _mm256_set1_epi32(row[k]);
+            int j = colBegin;
+            for (; j + 8 <= colEnd; j += 8) {
+                __m256i current = _mm256_loadu_si256((const __m256i*)(row + j));
+                __m256i candidate = _mm256_add_epi32(toPivot, _mm256_loadu_si256((const __m256i*)(through + j)));
+                _mm256_storeu_si256((__m256i*)(row + j), _mm256_min_epi32(current, candidate));
+            }
+            minPlusTileScalar(dist, n, i, i + 1, j, colEnd, k, k + 1);
+        }
+    }
+}
+
+// Same GCC 12 false positive as knapsackRowAVX512
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+__attribute__((target("avx512f")))
+static void minPlusTileAVX512(long long* dist, int n, int rowBegin, int rowEnd, int colBegin, int colEnd,
+                              int pivotBegin, int pivotEnd) {
+    for (int k = pivotBegin; k < pivotEnd; k++) {
+        const long long* through = dist + (size_t)k * n;
+        for (int i = rowBegin; i < rowEnd; i++) {
+            long long* row = dist + (size_t)i * n;
+            __m512i toPivot = _mm512_set1_epi64(row[k]);
+            int j = colBegin;
+            for (; j + 8 <= colEnd; j += 8) {
+                __m512i current = _mm512_loadu_si512((const void*)(row + j));
+                __m512i candidate = _mm512_add_epi64(toPivot, _mm512_loadu_si512((const void*)(through + j)));
+                _mm512_storeu_si512((void*)(row + j), _mm512_min_epi64(current, candidate));
+            }
+            minPlusTileScalar(dist, n, i, i + 1, j, colEnd, k, k + 1);
+        }
+    }
+}
+
+__attribute__((target("avx512f")))
+static void minPlusTileAVX512(int* dist, int n, int rowBegin, int rowEnd, int colBegin, int colEnd,
+                              int pivotBegin, int pivotEnd) {
+    for (int k = pivotBegin; k < pivotEnd; k++) {
+        const int* through = dist + (size_t)k * n;
+        for (int i = rowBegin; i < rowEnd; i++) {
+            int* row = dist + (size_t)i * n;
+            __m512i toPivot = _mm512_set1_epi32(row[k]);
+            int j = colBegin;
+            for (; j + 16 <= colEnd; j += 16) {
+                __m512i current = _mm512_loadu_si512((const void*)(row + j));
+                __m512i candidate = _mm512_add_epi32(toPivot, _mm512_loadu_si512((const void*)(through + j)));
+                _mm512_storeu_si512((void*)(row + j), _mm512_min_epi32(current, candidate));
+            }
+            minPlusTileScalar(dist, n, i, i + 1, j, colEnd, k, k + 1);
         }
     }
-    for (auto road : roads)
+}
+#pragma GCC diagnostic pop
+#endif
+
+// Widest tile kernel the CPU supports for this lane width
+template <typename T>
+static MinPlusTileKernel<T> minPlusTileKernel() {
+#ifdef ARCADIA_X86_SIMD
+    if (cpuHasAVX512()) return minPlusTileAVX512;
+    if (cpuHasAVX2()) return minPlusTileAVX2;
+#endif
+    return minPlusTileScalar<T>;
+}
+
+// For each pivot block: the diagonal tile, then the tiles sharing its row
+// or column (which only read the diagonal), then every other tile (which
+// only read the pivot row and column) split across threads
+template <typename T>
+static void floydWarshallBlocked(vector<T>& dist, int n, int threads) {
+    MinPlusTileKernel<T> relax = minPlusTileKernel<T>();
+    int blocks = (n + kFloydTile - 1) / kFloydTile;
+    int others = (blocks - 1) * (blocks - 1);
+    int workers = min(resolveThreadCount(threads), max(1, others));
+    auto relaxTile = [&](int rowBlock, int colBlock, int pivotBlock) {
+        relax(dist.data(), n, rowBlock * kFloydTile, min(n, (rowBlock + 1) * kFloydTile),
+              colBlock * kFloydTile, min(n, (colBlock + 1) * kFloydTile),
+              pivotBlock * kFloydTile, min(n, (pivotBlock + 1) * kFloydTile));
+    };
+
+    ThreadBarrier barrier(workers);
+    auto work = [&](int t) {
+        for (int pivot = 0; pivot < blocks; pivot++) {
+            if (t == 0) {
+                relaxTile(pivot, pivot, pivot);
+            }
+            barrier.arriveAndWait();
+
+            for (int b = t; b < blocks; b += workers) {
+                if (b == pivot) continue;
+                relaxTile(pivot, b, pivot);
+                relaxTile(b, pivot, pivot);
+            }
+            barrier.arriveAndWait();
+
+            // a contiguous run of tiles per thread so the pivot column tile is reused
+            int lo = (long long)blocks * blocks * t / workers;
+            int hi = (long long)blocks * blocks * (t + 1) / workers;
+            for (int tile = lo; tile < hi; tile++) {
+                int rowBlock = tile / blocks;
+                int colBlock = tile % blocks;
+                if (rowBlock == pivot || colBlock == pivot) continue;
+                relaxTile(rowBlock, colBlock, pivot);
+            }
+            barrier.arriveAndWait();
+        }
+    };
+
+    vector<thread> pool;
+    for (int t = 1; t < workers; t++) {
+        pool.emplace_back(work, t);
+    }
+    work(0);
+    for (auto& worker : pool) {
+        worker.join();
+    }
+}
+
+// Distance matrix in lanes of type T with unreachable pairs at inf, run
+// through the blocked Floyd-Warshall, summed over pairs i < j
+template <typename T>
+static unsigned __int128 sumMinDistancesBlocked(const WorldGraph& graph, T inf, int threads) {
+    int n = graph.vertexCount();
+    const vector<int>& offsets = graph.offsets();
+    const vector<int>& targets = graph.targets();
+    const vector<int>& weights = graph.weights(0);
+    // one contiguous heap block; a stack VLA overflowed around n = 700
+    vector<T> dist((size_t)n * n, inf);
+    for (int i = 0 ; i < n; i++)
     {
-        int u = road[0];
-        int v = road[1];
-        int distance = road[2];
-        dist[u][v] = distance;
-        dist[v][u] = distance;
+        dist[(size_t)i * n + i] = 0;
     }
-    for (int k = 0 ; k < n; k++)
+    for (int u = 0 ; u < n; u++)
     {
-        for (int i = 0 ; i < n; i++)
+        for (int e = offsets[u]; e < offsets[u + 1]; e++)
         {
-            for (int j = 0 ; j < n ; j++)
-            {
-                if (dist[i][k] != LLONG_MAX && dist[k][j] != LLONG_MAX)
-                {
-                    dist[i][j] = min(dist[i][j] , dist[i][k] + dist[k][j]);
-                }
-            }
+            int v = targets[e];
+            T distance = weights.empty() ? 0 : weights[e];
+            // keep the shortest of parallel roads; a self-loop never beats 0
+            T& cell = dist[(size_t)u * n + v];
+            cell = min(cell, distance);
         }
     }
+    floydWarshallBlocked(dist, n, threads);
+
+    // every distance is below 2^63 and there are fewer than 2^62 pairs,
+    // so the total fits in 128 bits without per-pair string additions
+    unsigned __int128 sum = 0;
     for (int i = 0 ; i < n; i++)
     {
         for (int j = 0 ; j < i; j++)
         {
-            if (dist[i][j] != LLONG_MAX )
+            if (dist[(size_t)i * n + j] != inf)
             {
-                string bin = decimalToBinary(dist[i][j]);
-                sumBinary = binaryAdd(sumBinary, bin);
+                sum += dist[(size_t)i * n + j];
+            }
+        }
+    }
+    return sum;
+}
+
+// --- All-pairs Dijkstra ---
+// Indexed 4-ary min-heap of vertices keyed by dist[v]. Each vertex is in
+// the heap at most once and improvements sift it up in place, so a search
+// does n pops instead of one per relaxed road
+class DistanceHeap {
+private:
+    const vector<long long>& dist;
+    vector<int> heap;
+    vector<int> slot; // position of each vertex in heap, -1 when absent
+
+    void siftUp(int i) {
+        int v = heap[i];
+        long long d = dist[v];
+        while (i > 0) {
+            int parent = (i - 1) / 4;
+            if (dist[heap[parent]] <= d) break;
+            heap[i] = heap[parent];
+            slot[heap[i]] = i;
+            i = parent;
+        }
+        heap[i] = v;
+        slot[v] = i;
+    }
+
+    void siftDown(int i) {
+        int v = heap[i];
+        long long d = dist[v];
+        int size = heap.size();
+        for (;;) {
+            int first = 4 * i + 1;
+            if (first >= size) break;
+            int best = first;
+            long long bestDist = dist[heap[first]];
+            for (int c = first + 1; c < min(size, first + 4); c++) {
+                if (dist[heap[c]] < bestDist) {
+                    bestDist = dist[heap[c]];
+                    best = c;
+                }
+            }
+            if (bestDist >= d) break;
+            heap[i] = heap[best];
+            slot[heap[i]] = i;
+            i = best;
+        }
+        heap[i] = v;
+        slot[v] = i;
+    }
+
+public:
+    explicit DistanceHeap(const vector<long long>& dist) : dist(dist), slot(dist.size(), -1) {}
+
+    bool empty() const { return heap.empty(); }
+
+    // insert v, or move it up after dist[v] dropped
+    void update(int v) {
+        if (slot[v] < 0) {
+            heap.push_back(v);
+            siftUp(heap.size() - 1);
+        } else {
+            siftUp(slot[v]);
+        }
+    }
+
+    int pop() {
+        int top = heap[0];
+        slot[top] = -1;
+        int last = heap.back();
+        heap.pop_back();
+        if (!heap.empty()) {
+            heap[0] = last;
+            siftDown(0);
+        }
+        return top;
+    }
+};
+
+// Sum over pairs t < s of d(s, t), running Dijkstra from every source s.
+// Threads take sources in small batches from a shared counter; each keeps
+// its own heap, distance buffer and running total, and the distance
+// buffer is reset only where a search reached, so memory stays O(V + E)
+static unsigned __int128 sumMinDistancesDijkstra(const WorldGraph& graph, int threads) {
+    const int sourcesPerBatch = 16;
+    int n = graph.vertexCount();
+    const vector<int>& offsets = graph.offsets();
+    const vector<int>& targets = graph.targets();
+    const vector<int>& weights = graph.weights(0);
+    int workers = min(resolveThreadCount(threads), max(1, n / sourcesPerBatch));
+
+    atomic<int> nextSource(0);
+    vector<unsigned __int128> totals(workers, 0);
+    auto work = [&](int t) {
+        vector<long long> dist(n, LLONG_MAX);
+        DistanceHeap heap(dist);
+        vector<int> reached;
+        unsigned __int128 total = 0;
+        for (;;) {
+            int lo = nextSource.fetch_add(sourcesPerBatch);
+            if (lo >= n) break;
+            int hi = min(n, lo + sourcesPerBatch);
+            for (int s = lo; s < hi; s++) {
+                dist[s] = 0;
+                reached.push_back(s);
+                heap.update(s);
+                while (!heap.empty()) {
+                    int u = heap.pop();
+                    long long d = dist[u];
+                    if (u < s) total += d;
+                    for (int e = offsets[u]; e < offsets[u + 1]; e++) {
+                        int v = targets[e];
+                        long long candidate = d + (weights.empty() ? 0 : weights[e]);
+                        if (candidate < dist[v]) {
+                            if (dist[v] == LLONG_MAX) reached.push_back(v);
+                            dist[v] = candidate;
+                            heap.update(v);
+                        }
+                    }
+                }
+                for (int v : reached) {
+                    dist[v] = LLONG_MAX;
+                }
+                reached.clear();
             }
         }
+        totals[t] = total;
+    };
+
+    vector<thread> pool;
+    for (int t = 1; t < workers; t++) {
+        pool.emplace_back(work, t);
+    }
+    work(0);
+    for (auto& worker : pool) {
+        worker.join();
+    }
+    unsigned __int128 sum = 0;
+    for (unsigned __int128 total : totals) {
+        sum += total;
+    }
+    return sum;
+}
+
+string WorldNavigator::sumMinDistancesBinary(int n, vector<vector<int>>& roads) {
+    // Implement All-Pairs Shortest Path (Floyd-Warshall)
+    // Sum all shortest distances between unique pairs (i < j)
+    return sumMinDistancesBinary(WorldGraph(n, roads));
+}
+
+// Per-source Dijkstra cost in units of one Floyd-Warshall relaxation
+// (about 0.3ns with 32-bit SIMD lanes): a heap pop per vertex, a relaxation
+// per road end. Auto runs Dijkstra while n sources cost less than n^3
+static const long long kDijkstraVertexCost = 400;
+static const long long kDijkstraRoadCost = 24;
+
+string WorldNavigator::sumMinDistancesBinary(const WorldGraph& graph, APSPStrategy strategy, int threads) {
+    long long n = graph.vertexCount();
+    if (strategy == APSPStrategy::Auto) {
+        long long dijkstraCost = n * kDijkstraVertexCost + graph.roadCount() * kDijkstraRoadCost;
+        strategy = dijkstraCost < n * n ? APSPStrategy::Dijkstra : APSPStrategy::FloydWarshall;
+    }
+
+    unsigned __int128 sum;
+    if (strategy == APSPStrategy::Dijkstra) {
+        sum = sumMinDistancesDijkstra(graph, threads);
+    } else {
+        const vector<int>& weights = graph.weights(0);
+        long long heaviest = weights.empty() ? 0 : *max_element(weights.begin(), weights.end());
+        // a shortest path has at most n - 1 roads; if even that stays below the
+        // 32-bit sentinel, twice as many distances fit in each vector
+        sum = max(n - 1, 0LL) * heaviest < kFloydInf32
+            ? sumMinDistancesBlocked<int>(graph, kFloydInf32, threads)
+            : sumMinDistancesBlocked<long long>(graph, kFloydInf64, threads);
     }
     // Return the sum as a binary string
     // Hint: Handle large numbers carefully
-    return sumBinary;
+    return decimalToBinary(sum);
 }
 
 // =========================================================
@@ -5,6 +5,9 @@
 #include <vector>
 #include <string>
 #include <iostream>
+#include <memory>
+#include <string_view>
+#include <set>
 
 using namespace std;
 
@@ -26,37 +29,337 @@ public:
 
 class AuctionTree {
 public:
+    virtual ~AuctionTree() {}
+
     // Red-Black Tree Implementation
     virtual void insertItem(int itemID, int price) = 0;
     virtual void deleteItem(int itemID) = 0;
+
+    // Listing that expires at the given timestamp
+    virtual void insertItem(int itemID, int price, long long expiresAt) = 0;
+    // Remove every item with expiresAt <= now; return how many were removed
+    virtual int expireUpTo(long long now) = 0;
+    // Bytes of node storage in use (every slot ever allocated, sentinel included)
+    virtual size_t nodeBytes() const = 0;
 };
 
 // PART B: DYNAMIC PROGRAMMING
+// Solver used by maximizeCarryValueAdaptive (Auto picks one by input shape)
+enum class KnapsackStrategy {
+    Auto,
+    CapacityDP,      // O(n * capacity)
+    ValueDP,         // O(n * sum of values), min weight per value
+    MeetInTheMiddle, // O(2^(n/2) * n), n <= 40
+    BranchAndBound   // LP-relaxation bound, when no table fits; node-limited
+};
+
+// Knapsack DP over a fixed item set, run once up to maxCapacity so any
+// capacity query afterwards is O(1)
+class PreparedItemSet {
+public:
+    PreparedItemSet(const vector<pair<int, int>>& items, int maxCapacity);
+
+    // Best value within capacity; throws "Capacity not prepared" above maxCapacity
+    int bestValue(int capacity) const;
+    int maxCapacity() const;
+    const vector<pair<int, int>>& items() const;
+
+private:
+    vector<pair<int, int>> itemList;
+    vector<int> best;     // best[c] = max value with total weight <= c
+    int preparedCapacity;
+    long long totalWeight;
+};
+
+// Inventory that changes one pickup at a time. Adding an item is a single
+// O(W) row update; after a removal the next query rebuilds from the live
+// items. For long histories use InventorySystem::replayInventory instead
+class IncrementalKnapsack {
+public:
+    explicit IncrementalKnapsack(int capacity);
+
+    // Returns a handle for removeItem
+    int addItem(int weight, int value);
+    void removeItem(int handle);
+    // Best value of the current inventory within capacity
+    int bestValue();
+
+private:
+    int capacity;
+    vector<pair<int, int>> items;
+    vector<bool> alive;
+    vector<int> best; // DP row over the live items, stale while dirty
+    bool dirty;
+};
+
+// Streaming version of countStringPossibilities: feed the text in chunks
+// of any size; only the last two counts and the last character are kept
+class StringDecoder {
+public:
+    StringDecoder();
+
+    void feed(string_view chunk);
+    // Possibilities for everything fed so far, modulo 10^9 + 7
+    long long result() const;
+    void reset();
+
+private:
+    long long current;  // count for the text so far
+    long long previous; // count without the last character
+    char last;          // last character fed (lowercase), 0 if none
+    bool broken;        // saw 'w' or 'm', which the keyboard cannot produce
+};
+
 class InventorySystem {
 public:
     // Minimizes difference between two coin stacks
     static int optimizeLootSplit(int n, vector<int>& coins);
 
+    // Same split, but returns the coin indices of each stack (lighter stack first)
+    static pair<vector<int>, vector<int>> splitLootStacks(vector<int>& coins);
+
+    // Split among `players` stacks minimizing max - min; returns coin indices per
+    // player and always returns within roughly timeBudgetMs (best split found so far)
+    static vector<vector<int>> splitLootAmongParty(vector<int>& coins, int players, int timeBudgetMs);
+
     // 0/1 Knapsack logic
     static int maximizeCarryValue(int capacity, vector<pair<int, int>>& items);
 
+    // Indices of the items packed by an optimal solution
+    static vector<int> selectCarryItems(int capacity, vector<pair<int, int>>& items);
+
+    // Same result as maximizeCarryValue, DP rows split across threads (<= 0 means all cores)
+    static int maximizeCarryValueParallel(int capacity, vector<pair<int, int>>& items, int threads);
+
+    // Knapsack for huge capacities; values may exceed int when summed.
+    // Throws "Strategy does not fit this input" when a forced solver's table
+    // or item limit is exceeded (Auto never picks such a solver). Branch and
+    // bound that exhausts its node limit falls back to meet in the middle for
+    // up to 44 items and throws "Knapsack search budget exceeded" above that
+    static long long maximizeCarryValueAdaptive(long long capacity, vector<pair<int, int>>& items,
+                                                KnapsackStrategy strategy = KnapsackStrategy::Auto);
+
+    // Prepared set for these items, shared through an LRU cache keyed by the item list
+    static shared_ptr<const PreparedItemSet> prepareItemSet(vector<pair<int, int>>& items, int maxCapacity);
+
+    // Offline knapsack over a pickup/drop history. events[i] is one of
+    //   {0, weight, value}  add an item (its handle is i)
+    //   {1, handle}         remove that item
+    //   {2}                 query the best value within capacity
+    // Returns the answers of the queries in order, O(W log Q) per item
+    static vector<int> replayInventory(int capacity, vector<vector<int>>& events);
+
+    // Bounded knapsack: stacks[i] = {weight, value, count}, O(W) per stack
+    static long long maximizeCarryValueBounded(int capacity, vector<vector<int>>& stacks);
+
     // String decoding possibilities
     static long long countStringPossibilities(string s);
+
+    // Same count, input split across threads (<= 0 means all cores)
+    static long long countStringPossibilitiesParallel(const string& s, int threads);
+
+    // Counts for many messages packed in one buffer: message i is
+    // buffer[offsets[i], offsets[i + 1]), so offsets has one entry more than messages
+    static vector<long long> countStringPossibilitiesBatch(const string& buffer, const vector<int>& offsets);
 };
 
 // PART C: GRAPHS
+// Spanning-tree solver used by minBribeCost
+enum class MSTStrategy {
+    Auto,          // Prim above 64 roads per vertex, FilterKruskal below
+    Prim,          // binary heap, O(E log V); best on dense maps
+    FilterKruskal, // partition around a pivot, drop edges inside a component
+    Boruvka        // cheapest edge per component each round, edge scan split across threads
+};
+
+// All-pairs solver used by sumMinDistancesBinary
+enum class APSPStrategy {
+    Auto,          // whichever costs fewer relaxations for the map's size and road count
+    FloydWarshall, // blocked, O(V^3) time and a V x V matrix; best on dense maps
+    Dijkstra       // from every source in parallel, O(V E log V) time, O(V + E) memory
+};
+
+// Road network in compressed sparse row form, built once and shared by
+// every WorldNavigator query. Rows are {u, v, w0, w1}; each road is stored
+// in both directions and the first two weight columns are kept when present
+class WorldGraph {
+public:
+    WorldGraph(int n, const vector<vector<int>>& roads);
+
+    int vertexCount() const;
+    int roadCount() const;
+    // Roads leaving u are [offsets[u], offsets[u + 1]) of targets and weights
+    const vector<int>& offsets() const;
+    const vector<int>& targets() const;
+    // Empty when the rows did not have that column
+    const vector<int>& weights(int column) const;
+
+private:
+    int n;
+    int roads;
+    vector<int> offsetList;
+    vector<int> targetList;
+    vector<int> weightLists[2];
+};
+
+// Connectivity of one map for high-volume pathExists checks. Built once
+// with a union-find (path compression, union by rank); roads opened later
+// are added in near-O(1) each. Roads are never removed
+class ConnectivityIndex {
+public:
+    ConnectivityIndex(int n, const vector<vector<int>>& edges);
+    explicit ConnectivityIndex(const WorldGraph& graph);
+
+    void addRoad(int u, int v);
+    bool connected(int u, int v);
+    // answers[i] = connected(queries[i].first, queries[i].second)
+    vector<bool> connectedBatch(const vector<pair<int, int>>& queries);
+    // Same value for every vertex of one component (until more roads are added)
+    int representative(int u);
+    int componentCount() const;
+
+private:
+    int find(int x);
+
+    vector<int> parent;
+    vector<unsigned char> rank; // upper bound on tree height, < 32
+    int components;
+};
+
+// minBribeCost of one map for any (goldRate, silverRate). The tree only
+// depends on the ratio of the rates, so each tree found is cached with a
+// range of ratios where it is proven optimal; ranges grow towards the
+// breakpoints as queries come in, and a rate change inside a known range
+// costs O(log trees). Rates must be >= 0. Costs are summed in 128 bits and
+// a cost beyond long long throws
+class PreparedBribeMap {
+public:
+    explicit PreparedBribeMap(const WorldGraph& graph);
+
+    // Same as minBribeCost(graph, goldRate, silverRate), -1 if not connected
+    long long cost(long long goldRate, long long silverRate);
+    // Number of distinct optimal trees computed so far
+    int cachedTrees() const;
+
+private:
+    struct Road {
+        int u;
+        int v;
+        int gold;
+        int silver;
+    };
+    // Rates up to scale; ratios are compared by cross-multiplying
+    struct Ratio {
+        long long gold;
+        long long silver;
+    };
+    // One optimal tree and the ratios [lo, hi] where it stays optimal
+    struct Piece {
+        Ratio lo;
+        Ratio hi;
+        long long gold;   // total gold cost of the tree
+        long long silver; // total silver cost of the tree
+    };
+
+    pair<long long, long long> spanningTree(Ratio rates) const;
+    bool closeGap(size_t i);
+
+    int n;
+    bool connected;
+    vector<Road> roads;
+    vector<Piece> pieces; // sorted by ratio, disjoint apart from endpoints
+    long long hits;       // queries answered from a range wider than one ratio
+    long long probes;     // gap-closing attempts so far
+};
+
+// Minimum spanning tree of a map whose roads open and close over time, at
+// fixed rates. Opening a road is O(log n) amortized on a link-cut tree: it
+// replaces the most expensive road on the cycle it closes. Closing a spare
+// road is O(log m); closing a tree road walks both halves of the tree in
+// lockstep and takes the cheapest spare road leaving the smaller one, so
+// it costs O(smaller half and its spare roads)
+class DynamicBribeMap {
+public:
+    DynamicBribeMap(int n, long long goldRate, long long silverRate);
+
+    // Returns a handle for closeRoad
+    int openRoad(int u, int v, int goldCost, int silverCost);
+    void closeRoad(int handle);
+    // Same as minBribeCost over the open roads, -1 if not connected
+    long long cost() const;
+
+private:
+    enum RoadState { CLOSED, TREE, SPARE };
+    struct Road {
+        int u;
+        int v;
+        long long cost;
+        RoadState state;
+    };
+    // Link-cut tree node; vertices are nodes 0..n-1, road h is node n + h
+    struct Node {
+        int child[2];
+        int parent;
+        bool flipped;
+        int heaviest; // node with the largest cost in this splay subtree
+    };
+
+    long long nodeCost(int x) const;
+    bool isSplayRoot(int x) const;
+    void push(int x);
+    void pull(int x);
+    void rotate(int x);
+    void splay(int x);
+    void access(int x);
+    void makeRoot(int x);
+    int findRoot(int x);
+    bool linked(int u, int v);
+    void link(int x, int y);
+    void cut(int x, int y);
+    void addToTree(int handle);
+    void removeFromTree(int handle);
+    void addSpare(int handle);
+    void removeSpare(int handle);
+    int otherEnd(int handle, int x) const;
+
+    int n;
+    long long goldRate;
+    long long silverRate;
+    vector<Road> roads;
+    vector<Node> nodes;
+    vector<set<int>> treeRoadsAt;  // tree road handles at each vertex
+    vector<set<int>> spareRoadsAt; // open non-tree road handles at each vertex
+    vector<int> splayPath;         // scratch for splay
+    vector<int> sideMark;          // scratch for closeRoad: which half a vertex is in
+    int sideStamp;
+    int treeRoads;
+    long long total;
+};
+
 class WorldNavigator {
 public:
     // Return true if path exists
     static bool pathExists(int n, vector<vector<int>>& edges, int source, int dest);
+    static bool pathExists(const WorldGraph& graph, int source, int dest);
+
+    // Component ID of every vertex, numbered 0.. in order of each component's
+    // smallest vertex; work is split across threads (<= 0 means all cores)
+    static vector<int> labelComponents(const WorldGraph& graph, int threads);
 
     // Min cost to satisfy bandit demands
     // Return -1 if impossible
     static long long minBribeCost(int n, int m, long long goldRate, long long silverRate, 
                                   vector<vector<int>>& roadData);
+    // Weight columns are {goldCost, silverCost}
+    static long long minBribeCost(const WorldGraph& graph, long long goldRate, long long silverRate,
+                                  MSTStrategy strategy = MSTStrategy::Auto, int threads = 0);
                                   
     // Sum of min distances in binary
     static string sumMinDistancesBinary(int n, vector<vector<int>>& roads);
+    // Weight column 0 is the distance; either solver is split across
+    // threads (<= 0 means all cores)
+    static string sumMinDistancesBinary(const WorldGraph& graph, APSPStrategy strategy = APSPStrategy::Auto,
+                                        int threads = 0);
 };
 
 // PART D: GREEDY